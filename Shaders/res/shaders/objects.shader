@@ -0,0 +1,50 @@
+#shader vertex
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : enable
+
+layout(location = 0) in vec4 position;
+
+// Must match ObjectRecord in ObjectBuffer.h
+struct Object
+{
+    mat4 transform;
+    vec4 color;
+    uint materialIndex;
+};
+
+layout(std430, binding = 0) readonly buffer Objects
+{
+    Object objects[];
+};
+
+// Only read without draw parameters, set it to the base instance of the draw
+uniform int u_BaseObject;
+
+flat out vec4 v_Color;
+flat out uint v_MaterialIndex;
+
+void main()
+{
+#ifdef GL_ARB_shader_draw_parameters
+    int objectIndex = gl_BaseInstanceARB + gl_InstanceID;
+#else
+    int objectIndex = u_BaseObject + gl_InstanceID;
+#endif
+    Object object = objects[objectIndex];
+    gl_Position = object.transform * position;
+    v_Color = object.color;
+    v_MaterialIndex = object.materialIndex;
+};
+
+#shader fragment
+#version 430 core
+
+layout(location = 0) out vec4 color;
+
+flat in vec4 v_Color;
+flat in uint v_MaterialIndex;
+
+void main()
+{
+    color = v_Color;
+};
\ No newline at end of file
@@ -1,14 +1,22 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <memory>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <thread>
 
 #include "Renderer.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
+#include "Stats.h"
+#include "ObjectBuffer.h"
+#include "BatchRenderer2D.h"
+#include "MathKernels.h"
+#include "FramePacket.h"
+#include "SpscQueue.h"
 
 // Enum to differentiate which Shader we have
 struct ShaderProgramSource
@@ -109,30 +117,13 @@ static int CreateShader(const std::string& vertexShader, const std::string& frag
 // core - do not use any depricated functions
 // layout(location = 0) is the index of the attribute
 
-// Run our application
-int main(void)
-{
-	GLFWwindow* window;
-
-	/* Initialize the library */
-	if (!glfwInit())
-		return -1;
-
-	// Create the context with the core profile
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-	/* Create a windowed mode window and its OpenGL context */
-	window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
-	if (!window)
-	{
-		std::cout << "Error initializing GLFW!" << std::endl;
-		glfwTerminate();
-		return -1;
-	}
+// Triple buffered: one packet being simulated, one waiting here, one being rendered
+typedef SpscQueue<FramePacket, 1> FramePacketQueue;
 
-	/* Make the window's context current */
+// Owns the OpenGL context, draws every packet the main thread sends until it gets the quit packet
+static void RenderThreadMain(GLFWwindow* window, FramePacketQueue* packets, std::atomic<bool>* initialized, std::atomic<bool>* failed)
+{
+	/* Make the window's context current on this thread */
 	glfwMakeContextCurrent(window);
 
 	// Sync this window with our monitors refresh rate
@@ -142,11 +133,14 @@ int main(void)
 	if (glewInit() != GLEW_OK) 
 	{
 		std::cout << "Error initializing GLEW!" << std::endl;
-		glfwTerminate();
-		return -1;
+		glfwMakeContextCurrent(NULL);
+		failed->store(true);
+		initialized->store(true);
+		return;
 	}
 	// Display the GL version
 	std::cout << glGetString(GL_VERSION) << std::endl;
+	initialized->store(true);
 
 	// Scope to keep the OpenGL context
 	{
@@ -168,6 +162,9 @@ int main(void)
 		GLCall(glGenVertexArrays(1, &vao));
 		GLCall(glBindVertexArray(vao));
 
+		// Count the GL calls it takes to build a mesh, DSA needs far fewer
+		unsigned long long glCallsBefore = GetRenderCounters().glCalls;
+
 		VertexArray va;
 		VertexBuffer vb(positions, 4 * 2 * sizeof(float));
 		VertexBufferLayout layout;
@@ -176,20 +173,49 @@ int main(void)
 
 		// Create an IndexBuffer
 		IndexBuffer ib(indices, 6);
+		va.SetIndexBuffer(ib);
+
+		std::cout << "Mesh creation took " << GetRenderCounters().glCalls - glCallsBefore << " GL calls"
+			<< (GLHasDirectStateAccess() ? " (DSA)" : "") << std::endl;
+
+		// Show what the buffers cost us
+		PrintRenderStats(std::cout);
+
+		// Quads per second through the batch renderer, a million tiny quads drawn once before the first frame
+		{
+			ShaderProgramSource batchSource = ParseShader("res/shaders/batch.shader");
+			unsigned int batchShader = CreateShader(batchSource.VertexSource, batchSource.FragmentSource);
+			BatchRenderer2D batch(batchShader);
+			double quadsPerSecond = MeasureQuadThroughput(batch, 1000000);
+			std::cout << "Batch renderer: " << quadsPerSecond / 1e6 << " million quads/s in " << batch.GetDrawCalls() << " draw calls" << std::endl;
+			GLCall(glDeleteProgram(batchShader));
+		}
+		// And the math kernels at every SIMD level against scalar
+		BenchmarkMathKernels(std::cout);
+
+		// With storage buffers the color comes from the per object record, so no uniform is set per draw
+		const bool useObjectBuffer = ObjectBuffer::IsSupported();
+		std::unique_ptr<ObjectBuffer> objects;
+		if (useObjectBuffer)
+			objects.reset(new ObjectBuffer(16));
 
 		// Shader source loaded from our res dir
-		ShaderProgramSource source = ParseShader("res/shaders/Basic.shader");
+		ShaderProgramSource source = ParseShader(useObjectBuffer ? "res/shaders/objects.shader" : "res/shaders/Basic.shader");
 
 		// Compile our shaders together
 		unsigned int shader = CreateShader(source.VertexSource, source.FragmentSource);
 		// Bind our shader
 		GLCall(glUseProgram(shader));
 
-		// Retrieve the uniforms ID
-		GLCall(int location = glGetUniformLocation(shader, "u_Color"));
-		ASSERT(location != -1);
-		// Pass our data to the shader uniform
-		GLCall(glUniform4f(location, 0.8f, 0.3f, 0.8f, 1.0f));
+		int location = -1;
+		if (!useObjectBuffer)
+		{
+			// Retrieve the uniforms ID
+			GLCall(location = glGetUniformLocation(shader, "u_Color"));
+			ASSERT(location != -1);
+			// Pass our data to the shader uniform
+			GLCall(glUniform4f(location, 0.8f, 0.3f, 0.8f, 1.0f));
+		}
 
 		// Unbind everything
 		GLCall(glBindVertexArray(0));
@@ -197,43 +223,123 @@ int main(void)
 		GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
 		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 
-		float r = 0.0f;
-		float increment = 0.05f;
+		Renderer renderer;
 
-		/* Loop until the user closes the window */
-		while (!glfwWindowShouldClose(window))
+		/* Loop until the main thread tells us to stop */
+		FramePacket packet;
+		while (true)
 		{
+			// Sleep until the next frame from the simulation
+			packets->Pop(packet);
+			if (packet.quit)
+				break;
+
 			/* Render here */
-			GLCall(glClear(GL_COLOR_BUFFER_BIT));
+			renderer.Clear();
 
-			// Bind the shader program & Pass our data to the shader uniform
+			// Bind the shader program & Pass our data to the shader
 			GLCall(glUseProgram(shader));
-			GLCall(glUniform4f(location, r, 0.3f, 0.8f, 1.0f));
-
-			// Bind the index buffer & vertex array
-			va.Bind();
-			ib.Bind();
+			if (useObjectBuffer)
+			{
+				// One record per object written in bulk, the quad is object 0 and draws with base instance 0
+				ObjectRecord record = { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f },
+					{ packet.red, 0.3f, 0.8f, 1.0f }, 0, { 0, 0, 0 } };
+				objects->Begin();
+				objects->Add(record);
+				objects->Upload();
+			}
+			else if (GLHasDirectStateAccess())
+			{
+				GLCall(glProgramUniform4f(shader, location, packet.red, 0.3f, 0.8f, 1.0f));
+			}
+			else
+			{
+				GLCall(glUniform4f(location, packet.red, 0.3f, 0.8f, 1.0f));
+			}
 
 			// Draw our buffer
-			GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
-
-			// Animate Red Channel
-			if (r > 1.0f) increment = -0.05f;
-			else if (r < 0.0f) increment = 0.05f;
-			r += increment;
-
-
+			renderer.Draw(va, ib);
 
 			/* Swap front and back buffers */
 			glfwSwapBuffers(window);
-
-			/* Poll for and process events */
-			glfwPollEvents();
 		}
 
 		GLCall(glDeleteProgram(shader));
 	}
 
+	glfwMakeContextCurrent(NULL);
+}
+
+// Run our application
+int main(void)
+{
+	GLFWwindow* window;
+
+	/* Initialize the library */
+	if (!glfwInit())
+		return -1;
+
+	// Create the context with the core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	/* Create a windowed mode window and its OpenGL context */
+	window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
+	if (!window)
+	{
+		std::cout << "Error initializing GLFW!" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// The context belongs to the render thread, this thread only handles the window and the simulation
+	FramePacketQueue packets;
+	std::atomic<bool> initialized(false);
+	std::atomic<bool> failed(false);
+	std::thread renderThread(RenderThreadMain, window, &packets, &initialized, &failed);
+
+	// Window events still have to be pumped while the render thread sets up
+	while (!initialized.load())
+		glfwWaitEventsTimeout(0.001);
+	if (failed.load())
+	{
+		renderThread.join();
+		glfwTerminate();
+		return -1;
+	}
+
+	FramePacket packet = {};
+	float r = 0.0f;
+	float increment = 0.05f;
+
+	/* Loop until the user closes the window */
+	while (!glfwWindowShouldClose(window))
+	{
+		/* Poll for and process events */
+		glfwPollEvents();
+
+		// Simulate this frame into a fresh packet
+		packet.frameIndex++;
+		packet.red = r;
+
+		// Animate Red Channel
+		if (r > 1.0f) increment = -0.05f;
+		else if (r < 0.0f) increment = 0.05f;
+		r += increment;
+
+		// Hand it over, waiting while the render thread is a full frame behind
+		// Sleeping in the event wait keeps the window responsive without spinning a core
+		while (!packets.TryPush(packet))
+			glfwWaitEventsTimeout(0.001);
+	}
+
+	// Tell the render thread to release its resources and the context
+	packet.quit = true;
+	while (!packets.TryPush(packet))
+		std::this_thread::yield();
+	renderThread.join();
+
 	glfwTerminate();
 	return 0;
 }
\ No newline at end of file
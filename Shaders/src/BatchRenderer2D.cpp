@@ -0,0 +1,230 @@
+#include "BatchRenderer2D.h"
+#include "Renderer.h"
+#include "TextureAtlas.h"
+
+#include <chrono>
+
+BatchRenderer2D::BatchRenderer2D(unsigned int program, unsigned int maxQuads)
+	: m_Program(program), m_MaxQuads(maxQuads), m_TextureSlotCount(1), m_TextureArray(0), m_RingOffset(0), m_RingSegment(0),
+	m_QuadCount(0), m_DrawCalls(0)
+{
+	// Room for RingSegments full batches, flushes append and wrap around
+	m_VertexBuffer.reset(new VertexBuffer(nullptr, RingSegments * maxQuads * 4 * sizeof(QuadVertex), true));
+	for (unsigned int segment = 0; segment < RingSegments; segment++)
+		m_SegmentFences[segment] = nullptr;
+	m_Vertices.reserve(maxQuads * 4);
+
+	// Every quad uses the same two triangles, so the index buffer never changes
+	std::vector<unsigned int> indices(maxQuads * 6);
+	for (unsigned int quad = 0; quad < maxQuads; quad++)
+	{
+		unsigned int first = quad * 4;
+		indices[quad * 6 + 0] = first + 0;
+		indices[quad * 6 + 1] = first + 1;
+		indices[quad * 6 + 2] = first + 2;
+		indices[quad * 6 + 3] = first + 2;
+		indices[quad * 6 + 4] = first + 3;
+		indices[quad * 6 + 5] = first + 0;
+	}
+	m_IndexBuffer.reset(new IndexBuffer(indices.data(), maxQuads * 6));
+
+	m_VertexArray.AddBuffer(*m_VertexBuffer, QuadVertexLayout());
+	m_VertexArray.SetIndexBuffer(*m_IndexBuffer);
+
+	// 1x1 white texture for quads that only have a color
+	unsigned int white = 0xFFFFFFFF;
+	GLCall(glGenTextures(1, &m_WhiteTexture));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_WhiteTexture));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	m_TextureSlots[0] = m_WhiteTexture;
+
+	// Point each sampler of the array at its own texture unit
+	int units[MaxTextureSlots];
+	for (int i = 0; i < (int)MaxTextureSlots; i++)
+		units[i] = i;
+	GLCall(glUseProgram(m_Program));
+	GLCall(int location = glGetUniformLocation(m_Program, "u_Textures"));
+	ASSERT(location != -1);
+	GLCall(glUniform1iv(location, MaxTextureSlots, units));
+	GLCall(int arrayLocation = glGetUniformLocation(m_Program, "u_TextureArray"));
+	ASSERT(arrayLocation != -1);
+	GLCall(glUniform1i(arrayLocation, TextureArrayUnit));
+	GLCall(glUseProgram(0));
+}
+
+BatchRenderer2D::~BatchRenderer2D()
+{
+	GLCall(glDeleteTextures(1, &m_WhiteTexture));
+	for (unsigned int segment = 0; segment < RingSegments; segment++)
+	{
+		if (m_SegmentFences[segment])
+		{
+			GLCall(glDeleteSync((GLsync)m_SegmentFences[segment]));
+		}
+	}
+}
+
+void BatchRenderer2D::Begin()
+{
+	m_Vertices.clear();
+	m_TextureSlotCount = 1;
+	m_TextureArray = 0;
+}
+
+unsigned int BatchRenderer2D::GetTextureSlot(unsigned int texture)
+{
+	for (unsigned int slot = 0; slot < m_TextureSlotCount; slot++)
+		if (m_TextureSlots[slot] == texture)
+			return slot;
+
+	// Out of units, draw what we have and start over with this texture
+	if (m_TextureSlotCount == MaxTextureSlots)
+		Flush();
+
+	m_TextureSlots[m_TextureSlotCount] = texture;
+	return m_TextureSlotCount++;
+}
+
+void BatchRenderer2D::DrawQuad(float x, float y, float width, float height, unsigned int color)
+{
+	DrawQuad(x, y, width, height, m_WhiteTexture, 0.0f, 0.0f, 1.0f, 1.0f, color);
+}
+
+void BatchRenderer2D::DrawQuad(float x, float y, float width, float height, unsigned int texture,
+	float u0, float v0, float u1, float v1, unsigned int color)
+{
+	if (m_Vertices.size() >= m_MaxQuads * 4)
+		Flush();
+
+	PushQuad(x, y, width, height, (float)GetTextureSlot(texture), -1.0f, u0, v0, u1, v1, color);
+}
+
+void BatchRenderer2D::DrawQuadLayer(float x, float y, float width, float height, unsigned int textureArray, unsigned int layer,
+	float u0, float v0, float u1, float v1, unsigned int color)
+{
+	if (m_Vertices.size() >= m_MaxQuads * 4 || (m_TextureArray != 0 && m_TextureArray != textureArray))
+		Flush();
+
+	m_TextureArray = textureArray;
+	PushQuad(x, y, width, height, 0.0f, (float)layer, u0, v0, u1, v1, color);
+}
+
+void BatchRenderer2D::DrawQuad(float x, float y, float width, float height, const TextureAtlas& atlas, unsigned int region, unsigned int color)
+{
+	ASSERT(atlas.GetTexture());
+	const AtlasRegion& r = atlas.GetRegion(region);
+	DrawQuadLayer(x, y, width, height, atlas.GetTexture()->GetRendererID(), r.layer, r.u0, r.v0, r.u1, r.v1, color);
+}
+
+void BatchRenderer2D::PushQuad(float x, float y, float width, float height, float slot, float layer,
+	float u0, float v0, float u1, float v1, unsigned int color)
+{
+	m_Vertices.push_back({ { x, y }, { u0, v0 }, color, slot, layer });
+	m_Vertices.push_back({ { x + width, y }, { u1, v0 }, color, slot, layer });
+	m_Vertices.push_back({ { x + width, y + height }, { u1, v1 }, color, slot, layer });
+	m_Vertices.push_back({ { x, y + height }, { u0, v1 }, color, slot, layer });
+}
+
+void BatchRenderer2D::End()
+{
+	Flush();
+}
+
+void BatchRenderer2D::WaitForSegment(unsigned int segment)
+{
+	GLsync fence = (GLsync)m_SegmentFences[segment];
+	if (!fence)
+		return;
+
+	// Only blocks when the GPU is a whole ring behind, which means it is the bottleneck anyway
+	GLenum result;
+	do
+	{
+		GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+	} while (result == GL_TIMEOUT_EXPIRED);
+	GLCall(glDeleteSync(fence));
+	m_SegmentFences[segment] = nullptr;
+}
+
+void BatchRenderer2D::Flush()
+{
+	// Without its vertex buffer, refused by the memory budget, the batch is dropped
+	if (!m_Vertices.empty() && m_VertexBuffer->IsAllocated())
+	{
+		unsigned int quadCount = (unsigned int)(m_Vertices.size() / 4);
+		unsigned int vertexCount = (unsigned int)m_Vertices.size();
+		unsigned int segmentSize = m_MaxQuads * 4;
+
+		// Append behind the previous flush, wrapping when the ring runs out
+		if (m_RingOffset + vertexCount > RingSegments * segmentSize)
+			m_RingOffset = 0;
+		unsigned int firstSegment = m_RingOffset / segmentSize;
+		unsigned int lastSegment = (m_RingOffset + vertexCount - 1) / segmentSize;
+		// Entering a segment again means the draws that last read it have to be done first
+		for (unsigned int segment = firstSegment; segment <= lastSegment; segment++)
+		{
+			if (segment != m_RingSegment)
+				WaitForSegment(segment);
+		}
+		// The write is unsynchronized, the driver neither stalls on the draws still reading the ring nor copies the data
+		// aside, the segment fences waited on above are what keep it off vertices in use
+		GLBufferSubDataUnsynchronized(m_VertexBuffer->GetRendererID(), (long long)m_RingOffset * sizeof(QuadVertex),
+			(long long)vertexCount * sizeof(QuadVertex), m_Vertices.data());
+
+		for (unsigned int slot = 0; slot < m_TextureSlotCount; slot++)
+		{
+			GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+			GLCall(glBindTexture(GL_TEXTURE_2D, m_TextureSlots[slot]));
+		}
+		if (m_TextureArray)
+		{
+			GLCall(glActiveTexture(GL_TEXTURE0 + TextureArrayUnit));
+			GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_TextureArray));
+		}
+
+		GLCall(glUseProgram(m_Program));
+		m_VertexArray.Bind();
+		// The base vertex moves the shared quad indices onto this flush's part of the ring
+		GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, quadCount * 6, m_IndexBuffer->GetType(), nullptr, (int)m_RingOffset));
+
+		for (unsigned int segment = firstSegment; segment <= lastSegment; segment++)
+		{
+			if (m_SegmentFences[segment])
+			{
+				GLCall(glDeleteSync((GLsync)m_SegmentFences[segment]));
+			}
+			GLCall(m_SegmentFences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		}
+		m_RingOffset += vertexCount;
+		m_RingSegment = lastSegment;
+
+		m_QuadCount += quadCount;
+		m_DrawCalls++;
+	}
+
+	Begin();
+}
+
+double MeasureQuadThroughput(BatchRenderer2D& renderer, unsigned int quadCount)
+{
+	// Finish first so earlier work is not timed, and again at the end so the GPU side of every flush is
+	GLCall(glFinish());
+	auto start = std::chrono::high_resolution_clock::now();
+
+	renderer.Begin();
+	for (unsigned int quad = 0; quad < quadCount; quad++)
+	{
+		// Tiny quads spread over the screen keep the fill rate out of the measurement
+		float x = (float)(quad % 1000) * 0.002f - 1.0f;
+		float y = (float)(quad / 1000 % 1000) * 0.002f - 1.0f;
+		renderer.DrawQuad(x, y, 0.001f, 0.001f, 0xFF000000 | quad);
+	}
+	renderer.End();
+
+	GLCall(glFinish());
+	std::chrono::duration<double> seconds = std::chrono::high_resolution_clock::now() - start;
+	return quadCount / seconds.count();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "StaticVertexLayout.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+class TextureAtlas;
+
+struct QuadVertex
+{
+	float position[2];
+	float texCoord[2];
+	unsigned int color; // RGBA8, red in the lowest byte
+	float texSlot;
+	float texLayer; // Layer of the bound texture array, negative to sample texSlot instead
+};
+
+typedef Layout<float2, float2, unorm8x4, float1, float1> QuadVertexLayout;
+ASSERT_VERTEX_LAYOUT(QuadVertex, QuadVertexLayout);
+
+// Appends sprites and UI quads into one streaming vertex buffer and draws them with as few calls as possible
+// Use with res/shaders/batch.shader, a draw happens whenever the batch or the texture slots fill up and at End
+// Besides the 2D slots one texture array can be bound per batch, so everything packed into a TextureAtlas draws with one binding
+class BatchRenderer2D
+{
+public:
+	static const unsigned int MaxTextureSlots = 15; // Must match u_Textures in batch.shader
+	static const unsigned int TextureArrayUnit = 15; // Unit of u_TextureArray, right after the 2D slots
+private:
+	// The vertex buffer holds this many full batches, each one a segment guarded by a fence so the unsynchronized
+	// writes of a flush never land on vertices an earlier draw is still reading
+	static const unsigned int RingSegments = 3;
+
+	unsigned int m_Program;
+	unsigned int m_MaxQuads;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer; // Ring every flush appends to, so it never overwrites vertices a draw may still read
+	std::unique_ptr<IndexBuffer> m_IndexBuffer; // Shared 0 1 2 2 3 0 pattern for every quad slot, built once
+	VertexArray m_VertexArray;
+	std::vector<QuadVertex> m_Vertices; // CPU side of the batch being built
+	unsigned int m_WhiteTexture; // Slot 0, lets untextured quads go through the same shader
+	unsigned int m_TextureSlots[MaxTextureSlots];
+	unsigned int m_TextureSlotCount;
+	unsigned int m_TextureArray; // Texture array of this batch, 0 while no quad uses one
+	unsigned int m_RingOffset; // First free vertex of the ring
+	unsigned int m_RingSegment; // Segment the last flush ended in
+	void* m_SegmentFences[RingSegments]; // GLsync after the last draw reading each segment, null once waited on
+
+	unsigned int m_QuadCount; // Quads drawn since ResetStats
+	unsigned int m_DrawCalls; // Draw calls since ResetStats
+
+	unsigned int GetTextureSlot(unsigned int texture);
+	void PushQuad(float x, float y, float width, float height, float slot, float layer, float u0, float v0, float u1, float v1, unsigned int color);
+	void WaitForSegment(unsigned int segment);
+public:
+	BatchRenderer2D(unsigned int program, unsigned int maxQuads = 10000);
+	~BatchRenderer2D();
+
+	void Begin();
+	// Positions are in clip space, color is RGBA8 with red in the lowest byte
+	void DrawQuad(float x, float y, float width, float height, unsigned int color);
+	// The UVs have no defaults, with them a call with only a texture would be ambiguous with the color overload
+	void DrawQuad(float x, float y, float width, float height, unsigned int texture,
+		float u0, float v0, float u1, float v1, unsigned int color = 0xFFFFFFFF);
+	// Quad from one layer of a GL_TEXTURE_2D_ARRAY, switching to another array flushes the batch
+	void DrawQuadLayer(float x, float y, float width, float height, unsigned int textureArray, unsigned int layer,
+		float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f, unsigned int color = 0xFFFFFFFF);
+	// Quad showing one region of a built atlas
+	void DrawQuad(float x, float y, float width, float height, const TextureAtlas& atlas, unsigned int region, unsigned int color = 0xFFFFFFFF);
+	void End();
+	// Draw whatever has been batched so far and start a new batch
+	void Flush();
+
+	inline unsigned int GetQuadCount() const { return m_QuadCount; }
+	inline unsigned int GetDrawCalls() const { return m_DrawCalls; }
+	inline void ResetStats() { m_QuadCount = 0; m_DrawCalls = 0; }
+};
+
+// Draw quadCount small quads through the renderer and return quads per second, including the GPU finishing them
+double MeasureQuadThroughput(BatchRenderer2D& renderer, unsigned int quadCount);
\ No newline at end of file
@@ -0,0 +1,442 @@
+#include "BoundingVolumeHierarchy.h"
+#include "FrustumCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static const unsigned int BinCount = 12;
+static const unsigned int MaxLeafSize = 4;
+// Relative cost of one node traversal step compared to testing one object
+static const float TraversalCost = 1.0f;
+
+static Aabb EmptyAabb()
+{
+	return { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+}
+
+static bool Overlaps(const Aabb& a, const Aabb& b)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		if (a.max[k] < b.min[k] || a.min[k] > b.max[k])
+			return false;
+	}
+	return true;
+}
+
+void Aabb::Grow(const Aabb& other)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		min[k] = std::min(min[k], other.min[k]);
+		max[k] = std::max(max[k], other.max[k]);
+	}
+}
+
+float Aabb::GetSurfaceArea() const
+{
+	float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+	if (x < 0.0f || y < 0.0f || z < 0.0f)
+		return 0.0f;
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+	: m_BuildCost(0.0f)
+{
+}
+
+void BoundingVolumeHierarchy::Build(const Aabb* bounds, unsigned int count)
+{
+	Clear();
+	if (count == 0)
+		return;
+
+	m_Bounds.assign(bounds, bounds + count);
+	m_ObjectLeaf.resize(count);
+	m_Objects.resize(count);
+	std::vector<float> centroids(count * 3);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		m_Objects[i] = i;
+		for (int k = 0; k < 3; k++)
+			centroids[i * 3 + k] = (bounds[i].min[k] + bounds[i].max[k]) * 0.5f;
+	}
+
+	// A binary tree with at least one object per leaf never has more than 2n - 1 nodes
+	m_Nodes.reserve(count * 2);
+	m_Nodes.push_back({ EmptyAabb(), 0, count, InvalidIndex });
+	RecomputeBounds(m_Nodes[0]);
+	Subdivide(0, centroids);
+
+	m_Dirty.assign(m_Nodes.size(), 0);
+	m_BuildCost = ComputeCost();
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+	m_Nodes.clear();
+	m_Objects.clear();
+	m_Bounds.clear();
+	m_ObjectLeaf.clear();
+	m_Dirty.clear();
+	m_BuildCost = 0.0f;
+}
+
+void BoundingVolumeHierarchy::Subdivide(unsigned int nodeIndex, const std::vector<float>& centroids)
+{
+	const unsigned int first = m_Nodes[nodeIndex].first;
+	const unsigned int count = m_Nodes[nodeIndex].count;
+
+	Aabb centroidBounds = EmptyAabb();
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		const float* c = &centroids[m_Objects[i] * 3];
+		Aabb point = { { c[0], c[1], c[2] }, { c[0], c[1], c[2] } };
+		centroidBounds.Grow(point);
+	}
+
+	// Evaluate the SAH at every bin boundary along every axis
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	unsigned int bestSplit = 0;
+	if (count > 1)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+			if (extent <= 0.0f)
+				continue;
+
+			Aabb binBounds[BinCount];
+			unsigned int binCounts[BinCount] = {};
+			for (unsigned int b = 0; b < BinCount; b++)
+				binBounds[b] = EmptyAabb();
+
+			float scale = BinCount / extent;
+			for (unsigned int i = first; i < first + count; i++)
+			{
+				unsigned int object = m_Objects[i];
+				unsigned int bin = std::min(BinCount - 1, (unsigned int)((centroids[object * 3 + axis] - centroidBounds.min[axis]) * scale));
+				binCounts[bin]++;
+				binBounds[bin].Grow(m_Bounds[object]);
+			}
+
+			// Sweep from the right to get the area and count of every right side, then from the left to price each split
+			float rightAreas[BinCount];
+			unsigned int rightCounts[BinCount];
+			Aabb right = EmptyAabb();
+			unsigned int rightCount = 0;
+			for (unsigned int b = BinCount - 1; b > 0; b--)
+			{
+				right.Grow(binBounds[b]);
+				rightCount += binCounts[b];
+				rightAreas[b] = right.GetSurfaceArea();
+				rightCounts[b] = rightCount;
+			}
+
+			Aabb left = EmptyAabb();
+			unsigned int leftCount = 0;
+			for (unsigned int b = 1; b < BinCount; b++)
+			{
+				left.Grow(binBounds[b - 1]);
+				leftCount += binCounts[b - 1];
+				if (leftCount == 0 || rightCounts[b] == 0)
+					continue;
+
+				float cost = left.GetSurfaceArea() * leftCount + rightAreas[b] * rightCounts[b];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+	}
+
+	float area = m_Nodes[nodeIndex].bounds.GetSurfaceArea();
+	float leafCost = area * count;
+	float splitCost = area * TraversalCost + bestCost;
+
+	unsigned int middle;
+	if (bestAxis >= 0 && (splitCost < leafCost || count > MaxLeafSize))
+	{
+		float extent = centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis];
+		float scale = BinCount / extent;
+		unsigned int* begin = m_Objects.data() + first;
+		unsigned int* split = std::partition(begin, begin + count, [&](unsigned int object) {
+			unsigned int bin = std::min(BinCount - 1, (unsigned int)((centroids[object * 3 + bestAxis] - centroidBounds.min[bestAxis]) * scale));
+			return bin < bestSplit;
+		});
+		middle = (unsigned int)(split - begin);
+	}
+	else if (count > MaxLeafSize)
+	{
+		// Every centroid sits on the same point, no plane can separate them so split down the middle
+		middle = count / 2;
+	}
+	else
+	{
+		for (unsigned int i = first; i < first + count; i++)
+			m_ObjectLeaf[m_Objects[i]] = nodeIndex;
+		return;
+	}
+
+	unsigned int leftIndex = (unsigned int)m_Nodes.size();
+	m_Nodes.push_back({ EmptyAabb(), first, middle, nodeIndex });
+	m_Nodes.push_back({ EmptyAabb(), first + middle, count - middle, nodeIndex });
+	RecomputeBounds(m_Nodes[leftIndex]);
+	RecomputeBounds(m_Nodes[leftIndex + 1]);
+
+	m_Nodes[nodeIndex].first = leftIndex;
+	m_Nodes[nodeIndex].count = 0;
+
+	Subdivide(leftIndex, centroids);
+	Subdivide(leftIndex + 1, centroids);
+}
+
+void BoundingVolumeHierarchy::RecomputeBounds(Node& node) const
+{
+	node.bounds = EmptyAabb();
+	if (node.count > 0)
+	{
+		for (unsigned int i = node.first; i < node.first + node.count; i++)
+			node.bounds.Grow(m_Bounds[m_Objects[i]]);
+	}
+	else
+	{
+		node.bounds.Grow(m_Nodes[node.first].bounds);
+		node.bounds.Grow(m_Nodes[node.first + 1].bounds);
+	}
+}
+
+void BoundingVolumeHierarchy::Update(unsigned int object, const Aabb& bounds)
+{
+	m_Bounds[object] = bounds;
+
+	// Mark the path to the root, stopping early where an earlier update already did
+	for (unsigned int node = m_ObjectLeaf[object]; node != InvalidIndex && !m_Dirty[node]; node = m_Nodes[node].parent)
+		m_Dirty[node] = 1;
+}
+
+void BoundingVolumeHierarchy::Refit()
+{
+	// Children are always stored after their parent, so a reverse sweep sees every child before its parent
+	for (unsigned int i = (unsigned int)m_Nodes.size(); i-- > 0;)
+	{
+		if (!m_Dirty[i])
+			continue;
+		RecomputeBounds(m_Nodes[i]);
+		m_Dirty[i] = 0;
+	}
+}
+
+float BoundingVolumeHierarchy::ComputeCost() const
+{
+	if (m_Nodes.empty())
+		return 0.0f;
+
+	float cost = 0.0f;
+	for (const Node& node : m_Nodes)
+		cost += node.bounds.GetSurfaceArea() * (node.count > 0 ? (float)node.count : TraversalCost);
+
+	float rootArea = m_Nodes[0].bounds.GetSurfaceArea();
+	return rootArea > 0.0f ? cost / rootArea : cost;
+}
+
+float BoundingVolumeHierarchy::GetRefitDegradation() const
+{
+	return m_BuildCost > 0.0f ? ComputeCost() / m_BuildCost : 1.0f;
+}
+
+void BoundingVolumeHierarchy::CollectSubtree(unsigned int nodeIndex, std::vector<unsigned int>& objects) const
+{
+	const Node& node = m_Nodes[nodeIndex];
+	if (node.count > 0)
+	{
+		objects.insert(objects.end(), m_Objects.begin() + node.first, m_Objects.begin() + node.first + node.count);
+		return;
+	}
+	CollectSubtree(node.first, objects);
+	CollectSubtree(node.first + 1, objects);
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& objects) const
+{
+	if (m_Nodes.empty())
+		return;
+
+	// Each stack entry carries the planes its parent still straddles, a subtree inside all of them is taken without further tests
+	struct Entry { unsigned int node; unsigned int planeMask; };
+	std::vector<Entry> stack;
+	stack.push_back({ 0, 0x3F });
+
+	while (!stack.empty())
+	{
+		Entry entry = stack.back();
+		stack.pop_back();
+		const Node& node = m_Nodes[entry.node];
+
+		float center[3], extent[3];
+		for (int k = 0; k < 3; k++)
+		{
+			center[k] = (node.bounds.min[k] + node.bounds.max[k]) * 0.5f;
+			extent[k] = (node.bounds.max[k] - node.bounds.min[k]) * 0.5f;
+		}
+
+		bool outside = false;
+		unsigned int planeMask = entry.planeMask;
+		for (unsigned int p = 0; p < 6 && !outside; p++)
+		{
+			if (!(planeMask & (1u << p)))
+				continue;
+
+			const float* plane = frustum.planes[p];
+			float distance = center[0] * plane[0] + center[1] * plane[1] + center[2] * plane[2] + plane[3];
+			float radius = extent[0] * std::fabs(plane[0]) + extent[1] * std::fabs(plane[1]) + extent[2] * std::fabs(plane[2]);
+			if (distance + radius < 0.0f)
+				outside = true;
+			else if (distance - radius >= 0.0f)
+				planeMask &= ~(1u << p);
+		}
+		if (outside)
+			continue;
+
+		if (planeMask == 0)
+		{
+			CollectSubtree(entry.node, objects);
+		}
+		else if (node.count > 0)
+		{
+			// Leaf bounds only prove that some of the objects might be visible
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				const Aabb& bounds = m_Bounds[m_Objects[i]];
+				bool visible = true;
+				for (unsigned int p = 0; p < 6 && visible; p++)
+				{
+					const float* plane = frustum.planes[p];
+					float distance = 0.0f, radius = 0.0f;
+					for (int k = 0; k < 3; k++)
+					{
+						distance += (bounds.min[k] + bounds.max[k]) * 0.5f * plane[k];
+						radius += (bounds.max[k] - bounds.min[k]) * 0.5f * std::fabs(plane[k]);
+					}
+					visible = distance + plane[3] + radius >= 0.0f;
+				}
+				if (visible)
+					objects.push_back(m_Objects[i]);
+			}
+		}
+		else
+		{
+			stack.push_back({ node.first + 1, planeMask });
+			stack.push_back({ node.first, planeMask });
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::QueryRegion(const Aabb& region, std::vector<unsigned int>& objects) const
+{
+	if (m_Nodes.empty())
+		return;
+
+	std::vector<unsigned int> stack;
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+		if (!Overlaps(node.bounds, region))
+			continue;
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				if (Overlaps(m_Bounds[m_Objects[i]], region))
+					objects.push_back(m_Objects[i]);
+			}
+		}
+		else
+		{
+			stack.push_back(node.first + 1);
+			stack.push_back(node.first);
+		}
+	}
+}
+
+// Slab test, returns the entry distance or FLT_MAX when the ray misses the box within maxDistance
+static float IntersectRay(const Aabb& bounds, const float* origin, const float* inverseDirection, float maxDistance)
+{
+	float entry = 0.0f, exit = maxDistance;
+	for (int k = 0; k < 3; k++)
+	{
+		float t0 = (bounds.min[k] - origin[k]) * inverseDirection[k];
+		float t1 = (bounds.max[k] - origin[k]) * inverseDirection[k];
+		if (t0 > t1)
+			std::swap(t0, t1);
+		entry = std::max(entry, t0);
+		exit = std::min(exit, t1);
+		if (entry > exit)
+			return FLT_MAX;
+	}
+	return entry;
+}
+
+unsigned int BoundingVolumeHierarchy::Raycast(const float* origin, const float* direction, float maxDistance, float* hitDistance) const
+{
+	if (m_Nodes.empty())
+		return InvalidIndex;
+
+	float inverseDirection[3];
+	for (int k = 0; k < 3; k++)
+		inverseDirection[k] = direction[k] != 0.0f ? 1.0f / direction[k] : FLT_MAX;
+
+	unsigned int closest = InvalidIndex;
+	float closestDistance = maxDistance;
+
+	std::vector<unsigned int> stack;
+	if (IntersectRay(m_Nodes[0].bounds, origin, inverseDirection, closestDistance) != FLT_MAX)
+		stack.push_back(0);
+
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				float distance = IntersectRay(m_Bounds[m_Objects[i]], origin, inverseDirection, closestDistance);
+				if (distance != FLT_MAX && distance <= closestDistance)
+				{
+					closestDistance = distance;
+					closest = m_Objects[i];
+				}
+			}
+			continue;
+		}
+
+		// Visit the nearer child first so the far one is usually rejected by the shrunken closestDistance
+		float leftDistance = IntersectRay(m_Nodes[node.first].bounds, origin, inverseDirection, closestDistance);
+		float rightDistance = IntersectRay(m_Nodes[node.first + 1].bounds, origin, inverseDirection, closestDistance);
+		unsigned int nearChild = node.first, farChild = node.first + 1;
+		if (rightDistance < leftDistance)
+		{
+			std::swap(leftDistance, rightDistance);
+			std::swap(nearChild, farChild);
+		}
+		if (rightDistance != FLT_MAX)
+			stack.push_back(farChild);
+		if (leftDistance != FLT_MAX)
+			stack.push_back(nearChild);
+	}
+
+	if (hitDistance && closest != InvalidIndex)
+		*hitDistance = closestDistance;
+	return closest;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+struct Frustum;
+
+struct Aabb
+{
+	float min[3];
+	float max[3];
+
+	void Grow(const Aabb& other);
+	float GetSurfaceArea() const;
+};
+
+// Bounding volume hierarchy over scene object bounds, object indices are the positions passed to Build
+// Built top down with binned SAH, moving objects are handled by Update + Refit which keeps the tree shape and only recomputes dirty nodes
+class BoundingVolumeHierarchy
+{
+public:
+	static const unsigned int InvalidIndex = 0xFFFFFFFF;
+
+	BoundingVolumeHierarchy();
+
+	void Build(const Aabb* bounds, unsigned int count);
+	void Clear();
+
+	// Change the bounds of one object, the tree is only correct again after Refit
+	void Update(unsigned int object, const Aabb& bounds);
+	void Refit();
+
+	void QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& objects) const;
+	void QueryRegion(const Aabb& region, std::vector<unsigned int>& objects) const;
+	// Closest object whose bounds the ray enters within maxDistance, InvalidIndex on a miss
+	unsigned int Raycast(const float* origin, const float* direction, float maxDistance, float* hitDistance = nullptr) const;
+
+	// SAH cost of the tree now divided by its cost right after Build, rebuild once refitting has degraded it too far
+	float GetRefitDegradation() const;
+
+	inline unsigned int GetObjectCount() const { return (unsigned int)m_Bounds.size(); }
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_Nodes.size(); }
+	inline const Aabb& GetBounds(unsigned int object) const { return m_Bounds[object]; }
+private:
+	// Leaves have count > 0 and index into m_Objects, inner nodes keep their two children at first and first + 1
+	struct Node
+	{
+		Aabb bounds;
+		unsigned int first;
+		unsigned int count;
+		unsigned int parent;
+	};
+
+	void Subdivide(unsigned int nodeIndex, const std::vector<float>& centroids);
+	void RecomputeBounds(Node& node) const;
+	void CollectSubtree(unsigned int nodeIndex, std::vector<unsigned int>& objects) const;
+	float ComputeCost() const;
+
+	std::vector<Node> m_Nodes;
+	std::vector<unsigned int> m_Objects;
+	std::vector<Aabb> m_Bounds;
+	std::vector<unsigned int> m_ObjectLeaf;
+	std::vector<unsigned char> m_Dirty;
+	float m_BuildCost;
+};
\ No newline at end of file
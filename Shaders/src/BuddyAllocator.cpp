@@ -0,0 +1,99 @@
+#include "BuddyAllocator.h"
+#include "Renderer.h"
+
+BuddyAllocator::BuddyAllocator(unsigned int capacity, unsigned int minBlockSize)
+	: m_MinBlockSize(minBlockSize), m_MaxOrder(0), m_UsedSize(0)
+{
+	ASSERT(minBlockSize > 0);
+	// Free finds a buddy by flipping the block size bit of the offset, which only works for power of two block sizes
+	ASSERT((minBlockSize & (minBlockSize - 1)) == 0);
+	ASSERT(capacity >= minBlockSize);
+
+	// Largest order whose block still fits inside the capacity, anything past that is unused
+	while (((unsigned long long)m_MinBlockSize << (m_MaxOrder + 1)) <= capacity)
+		m_MaxOrder++;
+
+	Reset();
+}
+
+unsigned int BuddyAllocator::GetOrderForSize(unsigned int size) const
+{
+	unsigned int order = 0;
+	while (order <= m_MaxOrder && GetBlockSize(order) < size)
+		order++;
+	return order;
+}
+
+unsigned int BuddyAllocator::Allocate(unsigned int size)
+{
+	if (size == 0)
+		size = 1;
+
+	unsigned int order = GetOrderForSize(size);
+	if (order > m_MaxOrder)
+		return InvalidOffset;
+
+	// Find the smallest free block that is big enough
+	unsigned int current = order;
+	while (current <= m_MaxOrder && m_FreeBlocks[current].empty())
+		current++;
+	if (current > m_MaxOrder)
+		return InvalidOffset;
+
+	unsigned int offset = *m_FreeBlocks[current].begin();
+	m_FreeBlocks[current].erase(m_FreeBlocks[current].begin());
+
+	// Split it down, returning the upper halves to the free lists
+	while (current > order)
+	{
+		current--;
+		m_FreeBlocks[current].insert(offset + GetBlockSize(current));
+	}
+
+	m_AllocatedBlocks[offset] = order;
+	m_UsedSize += GetBlockSize(order);
+	return offset;
+}
+
+void BuddyAllocator::Free(unsigned int offset)
+{
+	auto it = m_AllocatedBlocks.find(offset);
+	ASSERT(it != m_AllocatedBlocks.end());
+
+	unsigned int order = it->second;
+	m_AllocatedBlocks.erase(it);
+	m_UsedSize -= GetBlockSize(order);
+
+	// Merge with our buddy for as long as it is also free
+	while (order < m_MaxOrder)
+	{
+		unsigned int buddy = offset ^ GetBlockSize(order);
+		auto& freeBlocks = m_FreeBlocks[order];
+		auto buddyIt = freeBlocks.find(buddy);
+		if (buddyIt == freeBlocks.end())
+			break;
+
+		freeBlocks.erase(buddyIt);
+		offset = offset < buddy ? offset : buddy;
+		order++;
+	}
+
+	m_FreeBlocks[order].insert(offset);
+}
+
+void BuddyAllocator::Reset()
+{
+	m_FreeBlocks.assign(m_MaxOrder + 1, std::set<unsigned int>());
+	m_AllocatedBlocks.clear();
+	m_UsedSize = 0;
+
+	// Everything starts out as one big free block
+	m_FreeBlocks[m_MaxOrder].insert(0);
+}
+
+unsigned int BuddyAllocator::GetAllocationSize(unsigned int offset) const
+{
+	auto it = m_AllocatedBlocks.find(offset);
+	ASSERT(it != m_AllocatedBlocks.end());
+	return GetBlockSize(it->second);
+}
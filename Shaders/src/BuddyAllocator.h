@@ -0,0 +1,39 @@
+#pragma once
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Hands out power-of-two sized ranges from a fixed capacity without touching any memory itself
+// Offsets and sizes are in caller defined units (bytes, vertices, indices...)
+class BuddyAllocator
+{
+private:
+	unsigned int m_MinBlockSize; // Smallest block we will ever hand out
+	unsigned int m_MaxOrder; // Order of the single block that spans the whole capacity
+	std::vector<std::set<unsigned int>> m_FreeBlocks; // Free block offsets for each order, kept sorted so we fill from the front
+	std::unordered_map<unsigned int, unsigned int> m_AllocatedBlocks; // Offset -> order of every live allocation
+	unsigned int m_UsedSize; // Sum of all the live block sizes
+
+	unsigned int GetOrderForSize(unsigned int size) const;
+	inline unsigned int GetBlockSize(unsigned int order) const { return m_MinBlockSize << order; }
+public:
+	static const unsigned int InvalidOffset = 0xFFFFFFFF;
+
+	// minBlockSize must be a power of two, capacity can be anything but only its largest power of two block is used
+	BuddyAllocator(unsigned int capacity, unsigned int minBlockSize = 1);
+
+	// Returns the offset of a block holding at least size units, or InvalidOffset if nothing fits
+	unsigned int Allocate(unsigned int size);
+	// Returns a block to the allocator and merges it with its buddies where possible
+	void Free(unsigned int offset);
+	// Releases every allocation at once
+	void Reset();
+
+	// Size of the block backing an allocation (rounded up to a power of two)
+	unsigned int GetAllocationSize(unsigned int offset) const;
+
+	inline unsigned int GetCapacity() const { return GetBlockSize(m_MaxOrder); }
+	inline unsigned int GetUsedSize() const { return m_UsedSize; }
+	inline unsigned int GetAllocationCount() const { return (unsigned int)m_AllocatedBlocks.size(); }
+};
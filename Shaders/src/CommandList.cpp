@@ -0,0 +1,166 @@
+#include "CommandList.h"
+#include "Renderer.h"
+#include "IndexBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Argument blocks, everything is 4 byte sized so commands stay 4 byte aligned
+struct BindArguments { unsigned int name; };
+struct BindTextureArguments { unsigned int unit; unsigned int target; unsigned int texture; };
+struct Uniform1iArguments { int location; int value; };
+struct Uniform1fArguments { int location; float value; };
+struct Uniform4fArguments { int location; float value[4]; };
+struct UniformMatrix4Arguments { int location; float value[16]; };
+struct DrawIndexedArguments { unsigned int indexCount; unsigned int indexType; unsigned int firstIndex; int baseVertex; unsigned int instanceCount; };
+
+CommandList::CommandList(unsigned int order)
+	: m_Order(order), m_CommandCount(0)
+{
+}
+
+void CommandList::Reset()
+{
+	m_Data.clear();
+	m_CommandCount = 0;
+}
+
+template<typename T>
+void CommandList::Write(CommandType type, const T& arguments)
+{
+	CommandHeader header = { type, (unsigned short)sizeof(T) };
+	size_t offset = m_Data.size();
+	m_Data.resize(offset + sizeof(header) + sizeof(T));
+	memcpy(&m_Data[offset], &header, sizeof(header));
+	memcpy(&m_Data[offset + sizeof(header)], &arguments, sizeof(T));
+	m_CommandCount++;
+}
+
+void CommandList::BindProgram(unsigned int program)
+{
+	Write(CommandType::BindProgram, BindArguments{ program });
+}
+
+void CommandList::BindVertexArray(unsigned int vertexArray)
+{
+	Write(CommandType::BindVertexArray, BindArguments{ vertexArray });
+}
+
+void CommandList::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+	Write(CommandType::BindTexture, BindTextureArguments{ unit, target, texture });
+}
+
+void CommandList::SetUniform1i(int location, int value)
+{
+	Write(CommandType::Uniform1i, Uniform1iArguments{ location, value });
+}
+
+void CommandList::SetUniform1f(int location, float value)
+{
+	Write(CommandType::Uniform1f, Uniform1fArguments{ location, value });
+}
+
+void CommandList::SetUniform4f(int location, float x, float y, float z, float w)
+{
+	Write(CommandType::Uniform4f, Uniform4fArguments{ location, { x, y, z, w } });
+}
+
+void CommandList::SetUniformMatrix4(int location, const float* columnMajor)
+{
+	UniformMatrix4Arguments arguments;
+	arguments.location = location;
+	memcpy(arguments.value, columnMajor, sizeof(arguments.value));
+	Write(CommandType::UniformMatrix4, arguments);
+}
+
+void CommandList::DrawIndexed(unsigned int indexCount, unsigned int indexType, unsigned int firstIndex, int baseVertex, unsigned int instanceCount)
+{
+	Write(CommandType::DrawIndexed, DrawIndexedArguments{ indexCount, indexType, firstIndex, baseVertex, instanceCount });
+}
+
+// Copy the arguments out, the byte buffer gives no alignment guarantees
+template<typename T>
+static T Read(const unsigned char* data)
+{
+	T arguments;
+	memcpy(&arguments, data, sizeof(T));
+	return arguments;
+}
+
+void CommandList::Execute() const
+{
+	size_t offset = 0;
+	while (offset < m_Data.size())
+	{
+		CommandHeader header = Read<CommandHeader>(&m_Data[offset]);
+		const unsigned char* data = &m_Data[offset + sizeof(CommandHeader)];
+		offset += sizeof(CommandHeader) + header.size;
+
+		switch (header.type)
+		{
+			case CommandType::BindProgram:
+			{
+				GLCall(glUseProgram(Read<BindArguments>(data).name));
+				break;
+			}
+			case CommandType::BindVertexArray:
+			{
+				GLCall(glBindVertexArray(Read<BindArguments>(data).name));
+				break;
+			}
+			case CommandType::BindTexture:
+			{
+				BindTextureArguments arguments = Read<BindTextureArguments>(data);
+				GLCall(glActiveTexture(GL_TEXTURE0 + arguments.unit));
+				GLCall(glBindTexture(arguments.target, arguments.texture));
+				break;
+			}
+			case CommandType::Uniform1i:
+			{
+				Uniform1iArguments arguments = Read<Uniform1iArguments>(data);
+				GLCall(glUniform1i(arguments.location, arguments.value));
+				break;
+			}
+			case CommandType::Uniform1f:
+			{
+				Uniform1fArguments arguments = Read<Uniform1fArguments>(data);
+				GLCall(glUniform1f(arguments.location, arguments.value));
+				break;
+			}
+			case CommandType::Uniform4f:
+			{
+				Uniform4fArguments arguments = Read<Uniform4fArguments>(data);
+				GLCall(glUniform4fv(arguments.location, 1, arguments.value));
+				break;
+			}
+			case CommandType::UniformMatrix4:
+			{
+				UniformMatrix4Arguments arguments = Read<UniformMatrix4Arguments>(data);
+				GLCall(glUniformMatrix4fv(arguments.location, 1, GL_FALSE, arguments.value));
+				break;
+			}
+			case CommandType::DrawIndexed:
+			{
+				DrawIndexedArguments arguments = Read<DrawIndexedArguments>(data);
+				GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, arguments.indexCount, arguments.indexType,
+					(void*)((size_t)arguments.firstIndex * IndexBuffer::GetSizeOfType(arguments.indexType)), arguments.instanceCount, arguments.baseVertex));
+				break;
+			}
+			default:
+				ASSERT(false);
+		}
+	}
+}
+
+void ExecuteCommandLists(CommandList* const* lists, unsigned int count)
+{
+	// Stable so lists with the same order keep the order they were handed to us in
+	std::vector<CommandList*> sorted(lists, lists + count);
+	std::stable_sort(sorted.begin(), sorted.end(), [](const CommandList* a, const CommandList* b) {
+		return a->GetOrder() < b->GetOrder();
+	});
+
+	for (const CommandList* list : sorted)
+		list->Execute();
+}
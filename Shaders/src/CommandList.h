@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+enum class CommandType : unsigned short
+{
+	BindProgram = 0, BindVertexArray, BindTexture, Uniform1i, Uniform1f, Uniform4f, UniformMatrix4, DrawIndexed
+};
+
+// Records binds, uniform writes and draws into a flat byte buffer without touching GL, so any thread can fill one
+// Each command is a small header followed by its arguments, a list is replayed by the thread that owns the context
+class CommandList
+{
+private:
+	struct CommandHeader
+	{
+		CommandType type;
+		unsigned short size; // Bytes of arguments following the header
+	};
+
+	std::vector<unsigned char> m_Data;
+	unsigned int m_Order; // Lists run in ascending order no matter which thread finished first
+	unsigned int m_CommandCount;
+
+	template<typename T>
+	void Write(CommandType type, const T& arguments);
+public:
+	explicit CommandList(unsigned int order = 0);
+
+	// Start recording again, keeping the memory
+	void Reset();
+	inline void SetOrder(unsigned int order) { m_Order = order; }
+
+	void BindProgram(unsigned int program);
+	void BindVertexArray(unsigned int vertexArray);
+	void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+	// Uniforms go to whichever program the list bound last
+	void SetUniform1i(int location, int value);
+	void SetUniform1f(int location, float value);
+	void SetUniform4f(int location, float x, float y, float z, float w);
+	void SetUniformMatrix4(int location, const float* columnMajor);
+	void DrawIndexed(unsigned int indexCount, unsigned int indexType, unsigned int firstIndex = 0, int baseVertex = 0, unsigned int instanceCount = 1);
+
+	// Render thread: replay every command against GL
+	void Execute() const;
+
+	inline unsigned int GetOrder() const { return m_Order; }
+	inline unsigned int GetCommandCount() const { return m_CommandCount; }
+	inline unsigned int GetSize() const { return (unsigned int)m_Data.size(); }
+};
+
+// Render thread: run lists recorded on worker threads in a deterministic order (by GetOrder, then by position)
+void ExecuteCommandLists(CommandList* const* lists, unsigned int count);
\ No newline at end of file
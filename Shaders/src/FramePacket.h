@@ -0,0 +1,10 @@
+#pragma once
+
+// Everything the render thread needs to draw one frame, produced by the simulation on the main thread
+// Packets are copied into the queue and never changed after that
+struct FramePacket
+{
+	unsigned long long frameIndex;
+	float red; // Animated red channel of the quad color
+	bool quit; // Last packet, the render thread shuts down after seeing it
+};
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "FrustumCulling.h"
+#include "MathKernels.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRUSTUM_CULLING_SSE
+#endif
+
+// The AVX loops are picked at runtime, GCC and Clang only allow their intrinsics in functions targeting AVX
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define FRUSTUM_CULLING_AVX
+#if defined(_MSC_VER)
+#define FRUSTUM_CULLING_AVX_TARGET
+#else
+#define FRUSTUM_CULLING_AVX_TARGET __attribute__((target("avx")))
+#endif
+#endif
+
+// Not worth handing fewer objects than this to another thread
+static const unsigned int MinObjectsPerThread = 16 * 1024;
+
+Frustum Frustum::FromViewProjection(const float* m)
+{
+	// Row i of the matrix is (m[i], m[4 + i], m[8 + i], m[12 + i])
+	Frustum frustum;
+	for (int i = 0; i < 3; i++)
+	{
+		for (int k = 0; k < 4; k++)
+		{
+			frustum.planes[i * 2 + 0][k] = m[k * 4 + 3] + m[k * 4 + i];
+			frustum.planes[i * 2 + 1][k] = m[k * 4 + 3] - m[k * 4 + i];
+		}
+	}
+
+	for (auto& plane : frustum.planes)
+	{
+		float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		for (int k = 0; k < 4; k++)
+			plane[k] /= length;
+	}
+	return frustum;
+}
+
+void BoundingSphereSoA::Add(float centerX, float centerY, float centerZ, float sphereRadius)
+{
+	x.push_back(centerX);
+	y.push_back(centerY);
+	z.push_back(centerZ);
+	radius.push_back(sphereRadius);
+}
+
+void BoundingSphereSoA::Clear()
+{
+	x.clear(); y.clear(); z.clear(); radius.clear();
+}
+
+void BoundingBoxSoA::Add(const float* min, const float* max)
+{
+	centerX.push_back((min[0] + max[0]) * 0.5f);
+	centerY.push_back((min[1] + max[1]) * 0.5f);
+	centerZ.push_back((min[2] + max[2]) * 0.5f);
+	extentX.push_back((max[0] - min[0]) * 0.5f);
+	extentY.push_back((max[1] - min[1]) * 0.5f);
+	extentZ.push_back((max[2] - min[2]) * 0.5f);
+}
+
+void BoundingBoxSoA::Clear()
+{
+	centerX.clear(); centerY.clear(); centerZ.clear();
+	extentX.clear(); extentY.clear(); extentZ.clear();
+}
+
+// Push the index of every set bit in mask
+static void AppendVisible(std::vector<unsigned int>& visible, unsigned int base, unsigned int mask)
+{
+	while (mask)
+	{
+		unsigned int bit = 0;
+		while (!(mask & (1u << bit)))
+			bit++;
+		visible.push_back(base + bit);
+		mask &= mask - 1;
+	}
+}
+
+// The wide loops below return where they stopped, the scalar loop of the range function finishes the tail
+#ifdef FRUSTUM_CULLING_AVX
+FRUSTUM_CULLING_AVX_TARGET
+static unsigned int CullSpheresAVX(const Frustum& frustum, const BoundingSphereSoA& spheres, unsigned int i, unsigned int end, std::vector<unsigned int>& visible)
+{
+	const float* xs = spheres.x.data();
+	const float* ys = spheres.y.data();
+	const float* zs = spheres.z.data();
+	const float* rs = spheres.radius.data();
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(xs + i);
+		__m256 y = _mm256_loadu_ps(ys + i);
+		__m256 z = _mm256_loadu_ps(zs + i);
+		__m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(rs + i));
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const auto& plane : frustum.planes)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane[0])), _mm256_mul_ps(y, _mm256_set1_ps(plane[1]))),
+				_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane[2])), _mm256_set1_ps(plane[3])));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+		AppendVisible(visible, i, (unsigned int)_mm256_movemask_ps(inside));
+	}
+	return i;
+}
+#endif
+
+#ifdef FRUSTUM_CULLING_SSE
+static unsigned int CullSpheresSSE(const Frustum& frustum, const BoundingSphereSoA& spheres, unsigned int i, unsigned int end, std::vector<unsigned int>& visible)
+{
+	const float* xs = spheres.x.data();
+	const float* ys = spheres.y.data();
+	const float* zs = spheres.z.data();
+	const float* rs = spheres.radius.data();
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(xs + i);
+		__m128 y = _mm_loadu_ps(ys + i);
+		__m128 z = _mm_loadu_ps(zs + i);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(rs + i));
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const auto& plane : frustum.planes)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane[0])), _mm_mul_ps(y, _mm_set1_ps(plane[1]))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3])));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+		AppendVisible(visible, i, (unsigned int)_mm_movemask_ps(inside));
+	}
+	return i;
+}
+#endif
+
+static void CullSpheresRange(const Frustum& frustum, const BoundingSphereSoA& spheres, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible)
+{
+	const float* xs = spheres.x.data();
+	const float* ys = spheres.y.data();
+	const float* zs = spheres.z.data();
+	const float* rs = spheres.radius.data();
+	unsigned int i = begin;
+
+	SimdLevel level = GetSimdLevel();
+#ifdef FRUSTUM_CULLING_AVX
+	if (level == SimdLevel::AVX2)
+		i = CullSpheresAVX(frustum, spheres, i, end, visible);
+#endif
+#ifdef FRUSTUM_CULLING_SSE
+	if (level != SimdLevel::Scalar)
+		i = CullSpheresSSE(frustum, spheres, i, end, visible);
+#endif
+	(void)level;
+
+	for (; i < end; i++)
+	{
+		bool inside = true;
+		for (const auto& plane : frustum.planes)
+			inside = inside && xs[i] * plane[0] + ys[i] * plane[1] + zs[i] * plane[2] + plane[3] >= -rs[i];
+		if (inside)
+			visible.push_back(i);
+	}
+}
+
+// A box is outside a plane when its center is further out than its extent projected onto the normal
+#ifdef FRUSTUM_CULLING_AVX
+FRUSTUM_CULLING_AVX_TARGET
+static unsigned int CullBoxesAVX(const Frustum& frustum, const BoundingBoxSoA& boxes, unsigned int i, unsigned int end, std::vector<unsigned int>& visible)
+{
+	const float* cxs = boxes.centerX.data();
+	const float* cys = boxes.centerY.data();
+	const float* czs = boxes.centerZ.data();
+	const float* exs = boxes.extentX.data();
+	const float* eys = boxes.extentY.data();
+	const float* ezs = boxes.extentZ.data();
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(cxs + i), cy = _mm256_loadu_ps(cys + i), cz = _mm256_loadu_ps(czs + i);
+		__m256 ex = _mm256_loadu_ps(exs + i), ey = _mm256_loadu_ps(eys + i), ez = _mm256_loadu_ps(ezs + i);
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const auto& plane : frustum.planes)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane[0])), _mm256_mul_ps(cy, _mm256_set1_ps(plane[1]))),
+				_mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane[2])), _mm256_set1_ps(plane[3])));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(std::fabs(plane[0]))), _mm256_mul_ps(ey, _mm256_set1_ps(std::fabs(plane[1])))),
+				_mm256_mul_ps(ez, _mm256_set1_ps(std::fabs(plane[2]))));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+		AppendVisible(visible, i, (unsigned int)_mm256_movemask_ps(inside));
+	}
+	return i;
+}
+#endif
+
+#ifdef FRUSTUM_CULLING_SSE
+static unsigned int CullBoxesSSE(const Frustum& frustum, const BoundingBoxSoA& boxes, unsigned int i, unsigned int end, std::vector<unsigned int>& visible)
+{
+	const float* cxs = boxes.centerX.data();
+	const float* cys = boxes.centerY.data();
+	const float* czs = boxes.centerZ.data();
+	const float* exs = boxes.extentX.data();
+	const float* eys = boxes.extentY.data();
+	const float* ezs = boxes.extentZ.data();
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(cxs + i), cy = _mm_loadu_ps(cys + i), cz = _mm_loadu_ps(czs + i);
+		__m128 ex = _mm_loadu_ps(exs + i), ey = _mm_loadu_ps(eys + i), ez = _mm_loadu_ps(ezs + i);
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const auto& plane : frustum.planes)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane[0])), _mm_mul_ps(cy, _mm_set1_ps(plane[1]))),
+				_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3])));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::fabs(plane[0]))), _mm_mul_ps(ey, _mm_set1_ps(std::fabs(plane[1])))),
+				_mm_mul_ps(ez, _mm_set1_ps(std::fabs(plane[2]))));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+		AppendVisible(visible, i, (unsigned int)_mm_movemask_ps(inside));
+	}
+	return i;
+}
+#endif
+
+static void CullBoxesRange(const Frustum& frustum, const BoundingBoxSoA& boxes, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible)
+{
+	const float* cxs = boxes.centerX.data();
+	const float* cys = boxes.centerY.data();
+	const float* czs = boxes.centerZ.data();
+	const float* exs = boxes.extentX.data();
+	const float* eys = boxes.extentY.data();
+	const float* ezs = boxes.extentZ.data();
+	unsigned int i = begin;
+
+	SimdLevel level = GetSimdLevel();
+#ifdef FRUSTUM_CULLING_AVX
+	if (level == SimdLevel::AVX2)
+		i = CullBoxesAVX(frustum, boxes, i, end, visible);
+#endif
+#ifdef FRUSTUM_CULLING_SSE
+	if (level != SimdLevel::Scalar)
+		i = CullBoxesSSE(frustum, boxes, i, end, visible);
+#endif
+	(void)level;
+
+	for (; i < end; i++)
+	{
+		bool inside = true;
+		for (const auto& plane : frustum.planes)
+		{
+			float distance = cxs[i] * plane[0] + cys[i] * plane[1] + czs[i] * plane[2] + plane[3];
+			float radius = exs[i] * std::fabs(plane[0]) + eys[i] * std::fabs(plane[1]) + ezs[i] * std::fabs(plane[2]);
+			inside = inside && distance + radius >= 0.0f;
+		}
+		if (inside)
+			visible.push_back(i);
+	}
+}
+
+// Split [0, count) into contiguous chunks, one task each on the worker pool, and concatenate the results in order
+template<typename Function>
+static void CullParallel(unsigned int count, std::vector<unsigned int>& visible, unsigned int threadCount, Function cullRange)
+{
+	visible.clear();
+
+	if (threadCount == 0)
+		threadCount = WorkerPool::Get().GetThreadCount();
+	threadCount = std::min(threadCount, std::max(1u, count / MinObjectsPerThread));
+
+	if (threadCount == 1)
+	{
+		cullRange(0, count, visible);
+		return;
+	}
+
+	std::vector<std::vector<unsigned int>> results(threadCount);
+	WorkerPool::Get().ParallelFor(threadCount, [&cullRange, &results, count, threadCount](unsigned int t) {
+		unsigned int begin = (unsigned int)((unsigned long long)count * t / threadCount);
+		unsigned int end = (unsigned int)((unsigned long long)count * (t + 1) / threadCount);
+		cullRange(begin, end, results[t]);
+	});
+
+	for (const std::vector<unsigned int>& result : results)
+		visible.insert(visible.end(), result.begin(), result.end());
+}
+
+void CullSpheres(const Frustum& frustum, const BoundingSphereSoA& spheres, std::vector<unsigned int>& visible, unsigned int threadCount)
+{
+	CullParallel(spheres.GetCount(), visible, threadCount, [&frustum, &spheres](unsigned int begin, unsigned int end, std::vector<unsigned int>& out) {
+		CullSpheresRange(frustum, spheres, begin, end, out);
+	});
+}
+
+void CullBoxes(const Frustum& frustum, const BoundingBoxSoA& boxes, std::vector<unsigned int>& visible, unsigned int threadCount)
+{
+	CullParallel(boxes.GetCount(), visible, threadCount, [&frustum, &boxes](unsigned int begin, unsigned int end, std::vector<unsigned int>& out) {
+		CullBoxesRange(frustum, boxes, begin, end, out);
+	});
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+// Six planes (x, y, z, d) with normals pointing inside, a point p is inside a plane when dot(n, p) + d >= 0
+struct Frustum
+{
+	float planes[6][4];
+
+	// Gribb/Hartmann extraction from a column major view projection matrix, planes come out normalized
+	static Frustum FromViewProjection(const float* columnMajor);
+};
+
+// Bounding spheres stored as structure of arrays so a SIMD register holds the same field of several objects
+struct BoundingSphereSoA
+{
+	std::vector<float> x, y, z, radius;
+
+	void Add(float centerX, float centerY, float centerZ, float sphereRadius);
+	void Clear();
+	inline unsigned int GetCount() const { return (unsigned int)x.size(); }
+};
+
+// Axis aligned boxes as center and half extent, also structure of arrays
+struct BoundingBoxSoA
+{
+	std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+	void Add(const float* min, const float* max);
+	void Clear();
+	inline unsigned int GetCount() const { return (unsigned int)centerX.size(); }
+};
+
+// Write the indices of every object that may be visible into visible, in ascending order
+// Uses 8 objects per iteration with AVX, 4 with SSE, picked at runtime like the MathKernels, and splits large inputs
+// into threadCount chunks run on the WorkerPool (0 picks one per pool thread)
+void CullSpheres(const Frustum& frustum, const BoundingSphereSoA& spheres, std::vector<unsigned int>& visible, unsigned int threadCount = 0);
+void CullBoxes(const Frustum& frustum, const BoundingBoxSoA& boxes, std::vector<unsigned int>& visible, unsigned int threadCount = 0);
\ No newline at end of file
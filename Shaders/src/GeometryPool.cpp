@@ -0,0 +1,151 @@
+#include "GeometryPool.h"
+#include "Renderer.h"
+
+#include <algorithm>
+
+GeometryPool::GeometryPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity)
+	: m_Layout(layout), m_VertexCapacity(vertexCapacity), m_IndexCapacity(indexCapacity),
+	m_VertexAllocator(vertexCapacity), m_IndexAllocator(indexCapacity)
+{
+	CreateBuffers();
+	CreateVertexArray();
+}
+
+bool GeometryPool::CreateBuffers()
+{
+	// Allocate the storage up front, meshes get copied in with glBufferSubData later
+	m_VertexBuffer.reset(new VertexBuffer(nullptr, m_VertexCapacity * m_Layout.GetStride()));
+	m_IndexBuffer.reset(new IndexBuffer(nullptr, m_IndexCapacity));
+	return m_VertexBuffer->IsAllocated() && m_IndexBuffer->IsAllocated();
+}
+
+void GeometryPool::CreateVertexArray()
+{
+	// One vertex array for the whole pool, the index buffer binding is part of its state
+	m_VertexArray.reset(new VertexArray());
+	m_VertexArray->AddBuffer(*m_VertexBuffer, m_Layout);
+	m_VertexArray->SetIndexBuffer(*m_IndexBuffer);
+	// Without DSA the vertex array was bound to edit it, leave nothing bound behind
+	if (!GLHasDirectStateAccess())
+		m_VertexArray->Unbind();
+}
+
+unsigned int GeometryPool::AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	// The memory budget refused the pool its buffers, so there is no room at all
+	if (!m_VertexBuffer->IsAllocated() || !m_IndexBuffer->IsAllocated())
+		return InvalidHandle;
+
+	unsigned int vertexOffset = m_VertexAllocator.Allocate(vertexCount);
+	if (vertexOffset == BuddyAllocator::InvalidOffset)
+		return InvalidHandle;
+
+	unsigned int indexOffset = m_IndexAllocator.Allocate(indexCount);
+	if (indexOffset == BuddyAllocator::InvalidOffset)
+	{
+		m_VertexAllocator.Free(vertexOffset);
+		return InvalidHandle;
+	}
+
+	unsigned int stride = m_Layout.GetStride();
+	GLBufferSubData(m_VertexBuffer->GetRendererID(), (long long)vertexOffset * stride, (long long)vertexCount * stride, vertices);
+	GLBufferSubData(m_IndexBuffer->GetRendererID(), (long long)indexOffset * sizeof(unsigned int), (long long)indexCount * sizeof(unsigned int), indices);
+
+	MeshSlot slot = { { vertexOffset, vertexCount, indexOffset, indexCount }, true };
+	if (!m_FreeHandles.empty())
+	{
+		unsigned int handle = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+		m_Meshes[handle] = slot;
+		return handle;
+	}
+
+	m_Meshes.push_back(slot);
+	return (unsigned int)(m_Meshes.size() - 1);
+}
+
+void GeometryPool::RemoveMesh(unsigned int handle)
+{
+	ASSERT(handle < m_Meshes.size() && m_Meshes[handle].alive);
+
+	MeshSlot& slot = m_Meshes[handle];
+	m_VertexAllocator.Free(slot.range.vertexOffset);
+	m_IndexAllocator.Free(slot.range.indexOffset);
+	slot.alive = false;
+	m_FreeHandles.push_back(handle);
+}
+
+bool GeometryPool::Defragment()
+{
+	std::vector<unsigned int> live;
+	for (unsigned int i = 0; i < m_Meshes.size(); i++)
+		if (m_Meshes[i].alive)
+			live.push_back(i);
+
+	// Re-allocating the biggest blocks first packs a buddy allocator with no holes at all
+	std::vector<unsigned int> byVertexSize = live;
+	std::sort(byVertexSize.begin(), byVertexSize.end(), [this](unsigned int a, unsigned int b) {
+		return m_VertexAllocator.GetAllocationSize(m_Meshes[a].range.vertexOffset) > m_VertexAllocator.GetAllocationSize(m_Meshes[b].range.vertexOffset);
+	});
+	std::vector<unsigned int> byIndexSize = live;
+	std::sort(byIndexSize.begin(), byIndexSize.end(), [this](unsigned int a, unsigned int b) {
+		return m_IndexAllocator.GetAllocationSize(m_Meshes[a].range.indexOffset) > m_IndexAllocator.GetAllocationSize(m_Meshes[b].range.indexOffset);
+	});
+
+	// Keep the old buffers alive until everything has been copied across
+	std::unique_ptr<VertexBuffer> oldVertexBuffer = std::move(m_VertexBuffer);
+	std::unique_ptr<IndexBuffer> oldIndexBuffer = std::move(m_IndexBuffer);
+	if (!CreateBuffers())
+	{
+		// Both copies have to fit at once, over the memory budget the pool keeps its old buffers and stays fragmented
+		m_VertexBuffer = std::move(oldVertexBuffer);
+		m_IndexBuffer = std::move(oldIndexBuffer);
+		return false;
+	}
+	CreateVertexArray();
+
+	m_VertexAllocator.Reset();
+	m_IndexAllocator.Reset();
+
+	unsigned int stride = m_Layout.GetStride();
+	for (unsigned int handle : byVertexSize)
+	{
+		MeshRange& range = m_Meshes[handle].range;
+		unsigned int newOffset = m_VertexAllocator.Allocate(range.vertexCount);
+		ASSERT(newOffset != BuddyAllocator::InvalidOffset);
+		GLCopyBufferSubData(oldVertexBuffer->GetRendererID(), m_VertexBuffer->GetRendererID(),
+			(long long)range.vertexOffset * stride, (long long)newOffset * stride, (long long)range.vertexCount * stride);
+		range.vertexOffset = newOffset;
+	}
+
+	// Indices are relative to the base vertex so they can be copied as they are
+	for (unsigned int handle : byIndexSize)
+	{
+		MeshRange& range = m_Meshes[handle].range;
+		unsigned int newOffset = m_IndexAllocator.Allocate(range.indexCount);
+		ASSERT(newOffset != BuddyAllocator::InvalidOffset);
+		GLCopyBufferSubData(oldIndexBuffer->GetRendererID(), m_IndexBuffer->GetRendererID(),
+			(long long)range.indexOffset * sizeof(unsigned int), (long long)newOffset * sizeof(unsigned int), (long long)range.indexCount * sizeof(unsigned int));
+		range.indexOffset = newOffset;
+	}
+	return true;
+}
+
+void GeometryPool::Bind() const
+{
+	m_VertexArray->Bind();
+}
+
+void GeometryPool::Unbind() const
+{
+	m_VertexArray->Unbind();
+}
+
+void GeometryPool::Draw(unsigned int handle) const
+{
+	ASSERT(handle < m_Meshes.size() && m_Meshes[handle].alive);
+
+	const MeshRange& range = m_Meshes[handle].range;
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+		(void*)((size_t)range.indexOffset * sizeof(unsigned int)), range.vertexOffset));
+}
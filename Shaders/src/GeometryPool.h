@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "BuddyAllocator.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+
+// Where a mesh lives inside the shared buffers of a GeometryPool
+struct MeshRange
+{
+	unsigned int vertexOffset; // First vertex, passed as the base vertex when drawing
+	unsigned int vertexCount;
+	unsigned int indexOffset; // First index inside the shared index buffer
+	unsigned int indexCount;
+};
+
+// Packs many meshes with the same vertex layout into one large vertex buffer and one large index buffer
+// so they can all be drawn with a single vertex array bound
+class GeometryPool
+{
+private:
+	struct MeshSlot
+	{
+		MeshRange range;
+		bool alive;
+	};
+
+	VertexBufferLayout m_Layout;
+	unsigned int m_VertexCapacity;
+	unsigned int m_IndexCapacity;
+	BuddyAllocator m_VertexAllocator; // Hands out ranges in vertices so every offset is a valid base vertex
+	BuddyAllocator m_IndexAllocator; // Hands out ranges in indices
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	std::unique_ptr<VertexArray> m_VertexArray;
+	std::vector<MeshSlot> m_Meshes; // Indexed by mesh handle
+	std::vector<unsigned int> m_FreeHandles; // Dead slots we can hand out again
+
+	// False when the memory budget refused either buffer
+	bool CreateBuffers();
+	void CreateVertexArray();
+public:
+	static const unsigned int InvalidHandle = 0xFFFFFFFF;
+
+	GeometryPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity);
+
+	// Copy a mesh into the pool, returns InvalidHandle when the pool has no room left or never got its buffers
+	// Indices are relative to the mesh's own first vertex
+	unsigned int AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void RemoveMesh(unsigned int handle);
+
+	// Moves every live mesh to the front of fresh buffers so freed holes can be reused by larger meshes
+	// Handles stay valid, only their ranges change. Needs the old and new buffers at once, returns false and leaves
+	// the pool as it was when the memory budget has no room for the new ones
+	bool Defragment();
+
+	void Bind() const;
+	void Unbind() const;
+	// Draw one mesh, the pool must be bound
+	void Draw(unsigned int handle) const;
+
+	inline const MeshRange& GetRange(unsigned int handle) const { return m_Meshes[handle].range; }
+	inline unsigned int GetMeshCount() const { return (unsigned int)(m_Meshes.size() - m_FreeHandles.size()); }
+	inline const VertexArray& GetVertexArray() const { return *m_VertexArray; }
+	inline const VertexBuffer& GetVertexBuffer() const { return *m_VertexBuffer; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
+};
@@ -0,0 +1,98 @@
+#include "GpuMemory.h"
+#include "Renderer.h"
+
+#include <cstring>
+
+GpuMemoryTracker::GpuMemoryTracker()
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+GpuMemoryTracker& GpuMemoryTracker::Get()
+{
+	static GpuMemoryTracker tracker;
+	return tracker;
+}
+
+bool GpuMemoryTracker::Count(GpuMemoryCategory category, unsigned long long size, bool enforceBudget)
+{
+	GpuBudgetCallback callback;
+	GpuMemoryStats before;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_Stats.budget && m_Stats.current + size > m_Stats.budget)
+		{
+			callback = m_BudgetCallback;
+			before = m_Stats;
+		}
+	}
+
+	// Call back without the lock so the callback can free resources
+	if (callback)
+		callback(before, category, size);
+
+	// Check again under the same lock that counts, another thread may have taken the room the callback made
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (enforceBudget && m_Stats.budget && m_Stats.current + size > m_Stats.budget)
+	{
+		m_Stats.refusedAllocations++;
+		return false;
+	}
+
+	int index = (int)category;
+	m_Stats.current += size;
+	m_Stats.categoryCurrent[index] += size;
+	if (m_Stats.current > m_Stats.peak)
+		m_Stats.peak = m_Stats.current;
+	if (m_Stats.categoryCurrent[index] > m_Stats.categoryPeak[index])
+		m_Stats.categoryPeak[index] = m_Stats.categoryCurrent[index];
+	return true;
+}
+
+bool GpuMemoryTracker::TryAllocate(GpuMemoryCategory category, unsigned long long size)
+{
+	return Count(category, size, true);
+}
+
+void GpuMemoryTracker::Allocate(GpuMemoryCategory category, unsigned long long size)
+{
+	Count(category, size, false);
+}
+
+void GpuMemoryTracker::Free(GpuMemoryCategory category, unsigned long long size)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	int index = (int)category;
+	ASSERT(m_Stats.categoryCurrent[index] >= size);
+	m_Stats.current -= size;
+	m_Stats.categoryCurrent[index] -= size;
+}
+
+void GpuMemoryTracker::SetBudget(unsigned long long budget, GpuBudgetCallback callback)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.budget = budget;
+	m_BudgetCallback = callback;
+}
+
+GpuMemoryStats GpuMemoryTracker::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+const char* GpuMemoryTracker::GetCategoryName(GpuMemoryCategory category)
+{
+	switch (category)
+	{
+		case GpuMemoryCategory::VertexBuffer: return "Vertex Buffers";
+		case GpuMemoryCategory::IndexBuffer: return "Index Buffers";
+		case GpuMemoryCategory::Texture: return "Textures";
+		case GpuMemoryCategory::RenderTarget: return "Render Targets";
+		case GpuMemoryCategory::Other: return "Other";
+		default: break;
+	}
+
+	ASSERT(false);
+	return "";
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+
+enum class GpuMemoryCategory
+{
+	VertexBuffer = 0, IndexBuffer, Texture, RenderTarget, Other, Count
+};
+
+struct GpuMemoryStats
+{
+	unsigned long long current;
+	unsigned long long peak;
+	unsigned long long budget; // 0 when there is no budget
+	unsigned long long refusedAllocations; // TryAllocate calls turned down by the budget
+	unsigned long long categoryCurrent[(int)GpuMemoryCategory::Count];
+	unsigned long long categoryPeak[(int)GpuMemoryCategory::Count];
+};
+
+// Called before an allocation that would take us over the budget, with the stats before it is counted
+// Free something in here to make room, TryAllocate refuses the allocation if it still does not fit afterwards
+typedef std::function<void(const GpuMemoryStats& stats, GpuMemoryCategory category, unsigned long long size)> GpuBudgetCallback;
+
+// Central count of the GPU memory held by every resource class
+// Resources report their size before creating their storage and again when destroyed
+// Buffers, textures and render targets go through TryAllocate and are created without storage when it fails, so the
+// budget is a hard cap for them. Small internal buffers the renderer cannot run without use Allocate and always fit
+class GpuMemoryTracker
+{
+private:
+	mutable std::mutex m_Mutex;
+	GpuMemoryStats m_Stats;
+	GpuBudgetCallback m_BudgetCallback;
+
+	GpuMemoryTracker();
+	bool Count(GpuMemoryCategory category, unsigned long long size, bool enforceBudget);
+public:
+	static GpuMemoryTracker& Get();
+
+	// Call before the GL allocation, runs the callback when over budget and counts the memory only if it then fits
+	bool TryAllocate(GpuMemoryCategory category, unsigned long long size);
+	// Count memory that has to exist whatever the budget says, the callback still gets a chance to make room
+	void Allocate(GpuMemoryCategory category, unsigned long long size);
+	void Free(GpuMemoryCategory category, unsigned long long size);
+
+	// A budget of 0 turns the cap off
+	void SetBudget(unsigned long long budget, GpuBudgetCallback callback = GpuBudgetCallback());
+
+	GpuMemoryStats GetStats() const;
+
+	static const char* GetCategoryName(GpuMemoryCategory category);
+};
\ No newline at end of file
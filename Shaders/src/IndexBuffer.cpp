@@ -1,27 +1,153 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GpuMemory.h"
+
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define INDEX_BUFFER_SSE2
+#endif
+
+// Find the largest index so we know how narrow we can store them
+static unsigned int FindMaxIndex(const unsigned int* data, unsigned int count)
+{
+	unsigned int i = 0;
+	unsigned int result = 0;
+#ifdef INDEX_BUFFER_SSE2
+	// SSE2 only has a signed compare, flipping the top bit makes it order unsigned values correctly
+	const __m128i bias = _mm_set1_epi32((int)0x80000000);
+	__m128i maxValue = bias;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i value = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(data + i)), bias);
+		__m128i greater = _mm_cmpgt_epi32(value, maxValue);
+		maxValue = _mm_or_si128(_mm_and_si128(greater, value), _mm_andnot_si128(greater, maxValue));
+	}
+	unsigned int lanes[4];
+	_mm_storeu_si128((__m128i*)lanes, _mm_xor_si128(maxValue, bias));
+	for (unsigned int lane : lanes)
+		if (lane > result) result = lane;
+#endif
+	for (; i < count; i++)
+		if (data[i] > result) result = data[i];
+	return result;
+}
+
+// Narrow indices that are known to fit into 16 bits
+static void ConvertToShort(const unsigned int* data, unsigned short* out, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef INDEX_BUFFER_SSE2
+	// Shift into signed range so the saturating pack keeps every value, then shift back
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i low = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(data + i)), bias32);
+		__m128i high = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(data + i + 4)), bias32);
+		__m128i packed = _mm_xor_si128(_mm_packs_epi32(low, high), bias16);
+		_mm_storeu_si128((__m128i*)(out + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+		out[i] = (unsigned short)data[i];
+}
+
+// Narrow indices that are known to fit into 8 bits
+static void ConvertToByte(const unsigned int* data, unsigned char* out, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef INDEX_BUFFER_SSE2
+	// Every value is below 256 so both packs are exact
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i a = _mm_packs_epi32(_mm_loadu_si128((const __m128i*)(data + i)), _mm_loadu_si128((const __m128i*)(data + i + 4)));
+		__m128i b = _mm_packs_epi32(_mm_loadu_si128((const __m128i*)(data + i + 8)), _mm_loadu_si128((const __m128i*)(data + i + 12)));
+		_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+	}
+#endif
+	for (; i < count; i++)
+		out[i] = (unsigned char)data[i];
+}
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	: m_Count(count)
+	: m_Count(count), m_Type(GL_UNSIGNED_INT), m_Allocated(true)
 {
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-	GLCall(glGenBuffers(1, &m_Renderer_Id));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Renderer_Id));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	const void* uploadData = data;
+	std::vector<unsigned char> narrowed;
+	if (data)
+	{
+		unsigned int maxIndex = FindMaxIndex(data, count);
+		if (maxIndex <= 0xFF)
+		{
+			m_Type = GL_UNSIGNED_BYTE;
+			narrowed.resize(count);
+			ConvertToByte(data, narrowed.data(), count);
+			uploadData = narrowed.data();
+		}
+		else if (maxIndex <= 0xFFFF)
+		{
+			m_Type = GL_UNSIGNED_SHORT;
+			narrowed.resize(count * sizeof(unsigned short));
+			ConvertToShort(data, (unsigned short*)narrowed.data(), count);
+			uploadData = narrowed.data();
+		}
+	}
+
+	// Counted once the final index width is known but before the GL allocation, so the budget can refuse it
+	if (!GpuMemoryTracker::Get().TryAllocate(GpuMemoryCategory::IndexBuffer, GetSize()))
+	{
+		m_Count = 0;
+		m_Allocated = false;
+		uploadData = nullptr;
+	}
+
+	if (GLHasDirectStateAccess())
+	{
+		// Binding to GL_ELEMENT_ARRAY_BUFFER would also change whatever vertex array is bound, DSA avoids that
+		// Storage of size 0 is an error, an empty index buffer is left without any
+		GLCall(glCreateBuffers(1, &m_Renderer_Id));
+		if (m_Count)
+		{
+			GLCall(glNamedBufferStorage(m_Renderer_Id, GetSize(), uploadData, GL_DYNAMIC_STORAGE_BIT));
+		}
+	}
+	else
+	{
+		GLCall(glGenBuffers(1, &m_Renderer_Id));
+		GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Renderer_Id));
+		GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, GetSize(), uploadData, GL_STATIC_DRAW));
+	}
 }
 
 IndexBuffer::~IndexBuffer()
 {
 	GLCall(glDeleteBuffers(1, &m_Renderer_Id));
+	GpuMemoryTracker::Get().Free(GpuMemoryCategory::IndexBuffer, GetSize());
 }
 
 void IndexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_Renderer_Id));
+	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Renderer_Id));
 }
 
 void IndexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int type)
+{
+	switch (type)
+	{
+		case GL_UNSIGNED_BYTE: return 1;
+		case GL_UNSIGNED_SHORT: return 2;
+		case GL_UNSIGNED_INT: return 4;
+	}
+
+	ASSERT(false);
+	return 0;
 }
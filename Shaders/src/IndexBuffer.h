@@ -5,12 +5,24 @@ class IndexBuffer
 private:
 	unsigned int m_Renderer_Id; // ID for the renderer that we use to fetch the object from the renderer
 	unsigned int m_Count; // How many indices does this buffer have
+	unsigned int m_Type; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT depending on the largest index
+	bool m_Allocated; // False when the memory budget refused the storage, the buffer then has no indices
 public:
-	IndexBuffer(const unsigned int* data, unsigned int size);
+	// Stores the indices at the smallest width that can hold the largest one
+	// Passing no data reserves count 32 bit indices to be filled in later
+	// Over the memory budget the buffer is created empty, check IsAllocated
+	IndexBuffer(const unsigned int* data, unsigned int count);
 	~IndexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
 
 	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetType() const { return m_Type; }
+	inline unsigned int GetRendererID() const { return m_Renderer_Id; }
+	inline unsigned int GetSize() const { return m_Count * GetSizeOfType(m_Type); }
+	inline bool IsAllocated() const { return m_Allocated; }
+
+	// Size in bytes of one index of the given type
+	static unsigned int GetSizeOfType(unsigned int type);
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "LodSelector.h"
+#include "RenderQueue.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Keeps objects that contain the camera from dividing by zero, they always get full detail anyway
+static const float MinDistance = 1e-4f;
+
+LodSelector::LodSelector(float threshold, float hysteresis)
+	: m_Threshold(threshold), m_Hysteresis(hysteresis)
+{
+}
+
+unsigned int LodSelector::AddObject(const LodLevel* levels, unsigned int levelCount, const float* center, float radius)
+{
+	ASSERT(levelCount > 0);
+	Object object;
+	object.center[0] = center[0];
+	object.center[1] = center[1];
+	object.center[2] = center[2];
+	object.radius = radius;
+	object.firstLevel = (unsigned int)m_Levels.size();
+	object.levelCount = levelCount;
+	object.level = 0;
+
+	m_Levels.insert(m_Levels.end(), levels, levels + levelCount);
+	m_Objects.push_back(object);
+	return (unsigned int)m_Objects.size() - 1;
+}
+
+void LodSelector::SetPosition(unsigned int handle, const float* center)
+{
+	Object& object = m_Objects[handle];
+	object.center[0] = center[0];
+	object.center[1] = center[1];
+	object.center[2] = center[2];
+}
+
+void LodSelector::Clear()
+{
+	m_Objects.clear();
+	m_Levels.clear();
+}
+
+void LodSelector::Select(const float* cameraPosition, float projectionScale)
+{
+	const float coarserThreshold = m_Threshold * (1.0f - m_Hysteresis);
+
+	for (Object& object : m_Objects)
+	{
+		// Distance to the closest point of the bounding sphere gives the largest error any part of the object shows
+		float dx = object.center[0] - cameraPosition[0];
+		float dy = object.center[1] - cameraPosition[1];
+		float dz = object.center[2] - cameraPosition[2];
+		float distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz) - object.radius, MinDistance);
+		float pixelsPerUnit = projectionScale / distance;
+
+		const LodLevel* levels = &m_Levels[object.firstLevel];
+		if (levels[object.level].error * pixelsPerUnit > m_Threshold)
+		{
+			// Too coarse, step finer until the error is acceptable again
+			while (object.level > 0 && levels[object.level].error * pixelsPerUnit > m_Threshold)
+				object.level--;
+		}
+		else
+		{
+			while (object.level + 1 < object.levelCount && levels[object.level + 1].error * pixelsPerUnit <= coarserThreshold)
+				object.level++;
+		}
+	}
+}
+
+void LodSelector::Submit(RenderQueue& queue, unsigned long long key, unsigned int handle, const DrawCommand& command) const
+{
+	const LodLevel& level = GetSelectedLevel(handle);
+	DrawCommand draw = command;
+	draw.firstIndex = command.firstIndex + level.firstIndex;
+	draw.indexCount = level.indexCount;
+	draw.baseVertex = command.baseVertex + level.baseVertex;
+	queue.Submit(key, draw);
+}
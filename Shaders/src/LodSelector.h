@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "MeshSimplifier.h"
+
+class RenderQueue;
+struct DrawCommand;
+
+// Picks one discrete level of detail per object and frame from its projected screen space error
+// Going coarser needs the error to drop below the threshold by the hysteresis margin, going finer happens as soon as
+// the current level exceeds it, so an object sitting on a switching distance does not pop back and forth
+class LodSelector
+{
+public:
+	static const unsigned int InvalidHandle = 0xFFFFFFFF;
+
+	// threshold is the largest acceptable error in pixels, hysteresis is a fraction of it
+	LodSelector(float threshold = 1.0f, float hysteresis = 0.25f);
+
+	// Levels go from full detail to coarsest with increasing error, radius bounds the object around center
+	unsigned int AddObject(const LodLevel* levels, unsigned int levelCount, const float* center, float radius);
+	void SetPosition(unsigned int handle, const float* center);
+	void Clear();
+
+	// projectionScale turns an error at distance 1 into pixels, viewportHeight / (2 * tan(fovY / 2)) for a perspective camera
+	void Select(const float* cameraPosition, float projectionScale);
+
+	// Submit the selected level, everything but the index range comes from command
+	void Submit(RenderQueue& queue, unsigned long long key, unsigned int handle, const DrawCommand& command) const;
+
+	inline unsigned int GetLevel(unsigned int handle) const { return m_Objects[handle].level; }
+	inline const LodLevel& GetSelectedLevel(unsigned int handle) const { return m_Levels[m_Objects[handle].firstLevel + m_Objects[handle].level]; }
+	inline unsigned int GetObjectCount() const { return (unsigned int)m_Objects.size(); }
+	inline void SetThreshold(float threshold) { m_Threshold = threshold; }
+	inline void SetHysteresis(float hysteresis) { m_Hysteresis = hysteresis; }
+private:
+	struct Object
+	{
+		float center[3];
+		float radius;
+		unsigned int firstLevel;
+		unsigned int levelCount;
+		unsigned int level;
+	};
+
+	std::vector<Object> m_Objects;
+	std::vector<LodLevel> m_Levels;
+	float m_Threshold;
+	float m_Hysteresis;
+};
\ No newline at end of file
@@ -0,0 +1,515 @@
+#include "MathKernels.h"
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <ostream>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define MATH_KERNELS_X64
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC lets any function use AVX2 intrinsics, GCC and Clang need it enabled per function
+#define MATH_KERNELS_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define MATH_KERNELS_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+#ifdef MATH_KERNELS_X64
+static void Cpuid(int leaf, int subleaf, int* registers)
+{
+#if defined(_MSC_VER)
+	__cpuidex(registers, leaf, subleaf);
+#else
+	unsigned int a, b, c, d;
+	__cpuid_count(leaf, subleaf, a, b, c, d);
+	registers[0] = (int)a; registers[1] = (int)b; registers[2] = (int)c; registers[3] = (int)d;
+#endif
+}
+
+static unsigned long long ReadXcr0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int low, high;
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return ((unsigned long long)high << 32) | low;
+#endif
+}
+#endif
+
+SimdLevel DetectSimdLevel()
+{
+#ifdef MATH_KERNELS_X64
+	// SSE2 is part of x64 itself
+	int registers[4];
+	Cpuid(0, 0, registers);
+	int maxLeaf = registers[0];
+
+	Cpuid(1, 0, registers);
+	bool fma = (registers[2] & (1 << 12)) != 0;
+	bool f16c = (registers[2] & (1 << 29)) != 0;
+	bool osxsave = (registers[2] & (1 << 27)) != 0;
+	bool avx = (registers[2] & (1 << 28)) != 0;
+	// The OS has to save the xmm and ymm halves on context switches or AVX state gets lost
+	bool osAvx = osxsave && (ReadXcr0() & 0x6) == 0x6;
+
+	bool avx2 = false;
+	if (maxLeaf >= 7)
+	{
+		Cpuid(7, 0, registers);
+		avx2 = (registers[1] & (1 << 5)) != 0;
+	}
+	return avx && osAvx && avx2 && fma && f16c ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#elif defined(__SSE2__)
+	return SimdLevel::SSE2;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+static std::atomic<int> s_SimdLevel(-1);
+
+SimdLevel GetSimdLevel()
+{
+	int level = s_SimdLevel.load(std::memory_order_relaxed);
+	if (level < 0)
+	{
+		level = (int)DetectSimdLevel();
+		s_SimdLevel.store(level, std::memory_order_relaxed);
+	}
+	return (SimdLevel)level;
+}
+
+void SetSimdLevel(SimdLevel level)
+{
+	SimdLevel supported = DetectSimdLevel();
+	s_SimdLevel.store((int)(level < supported ? level : supported), std::memory_order_relaxed);
+}
+
+// ---- Scalar versions, also the tails of the wide ones ----
+
+static void TransformPointsScalar(const float* m, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int begin, unsigned int end)
+{
+	for (unsigned int i = begin; i < end; i++)
+	{
+		float px = x[i], py = y[i], pz = z[i];
+		outX[i] = m[0] * px + m[4] * py + m[8] * pz + m[12];
+		outY[i] = m[1] * px + m[5] * py + m[9] * pz + m[13];
+		outZ[i] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+	}
+}
+
+static void MultiplyMatricesScalar(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const float* l = a[i].m;
+		const float* r = b[i].m;
+		Mat4 result;
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+				result.m[column * 4 + row] = l[row] * r[column * 4] + l[4 + row] * r[column * 4 + 1]
+					+ l[8 + row] * r[column * 4 + 2] + l[12 + row] * r[column * 4 + 3];
+		}
+		out[i] = result;
+	}
+}
+
+static void TransformBoundsScalar(const Mat4* transforms, const Aabb* local, Aabb* world, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const float* m = transforms[i].m;
+		float center[3], extent[3];
+		for (int k = 0; k < 3; k++)
+		{
+			center[k] = (local[i].min[k] + local[i].max[k]) * 0.5f;
+			extent[k] = (local[i].max[k] - local[i].min[k]) * 0.5f;
+		}
+
+		// The new half extent along each axis is the extent projected onto the absolute matrix row
+		Aabb result;
+		for (int row = 0; row < 3; row++)
+		{
+			float c = m[row] * center[0] + m[4 + row] * center[1] + m[8 + row] * center[2] + m[12 + row];
+			float e = std::fabs(m[row]) * extent[0] + std::fabs(m[4 + row]) * extent[1] + std::fabs(m[8 + row]) * extent[2];
+			result.min[row] = c - e;
+			result.max[row] = c + e;
+		}
+		world[i] = result;
+	}
+}
+
+static void TransformBoundsSoAScalar(const Mat4* transforms, const AabbSoA& local, AabbSoA& world, unsigned int begin, unsigned int end)
+{
+	for (unsigned int i = begin; i < end; i++)
+	{
+		const float* m = transforms[i].m;
+		float center[3], extent[3];
+		for (int k = 0; k < 3; k++)
+		{
+			center[k] = (local.min[k][i] + local.max[k][i]) * 0.5f;
+			extent[k] = (local.max[k][i] - local.min[k][i]) * 0.5f;
+		}
+
+		for (int row = 0; row < 3; row++)
+		{
+			float c = m[row] * center[0] + m[4 + row] * center[1] + m[8 + row] * center[2] + m[12 + row];
+			float e = std::fabs(m[row]) * extent[0] + std::fabs(m[4 + row]) * extent[1] + std::fabs(m[8 + row]) * extent[2];
+			world.min[row][i] = c - e;
+			world.max[row][i] = c + e;
+		}
+	}
+}
+
+#if defined(MATH_KERNELS_X64) || defined(__SSE2__)
+// ---- SSE2, 4 points per step ----
+
+static void TransformPointsSSE2(const float* m, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count)
+{
+	__m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+	__m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+	__m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+	__m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
+
+	unsigned int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+		_mm_storeu_ps(outX + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, px), _mm_mul_ps(m4, py)), _mm_add_ps(_mm_mul_ps(m8, pz), m12)));
+		_mm_storeu_ps(outY + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, px), _mm_mul_ps(m5, py)), _mm_add_ps(_mm_mul_ps(m9, pz), m13)));
+		_mm_storeu_ps(outZ + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, px), _mm_mul_ps(m6, py)), _mm_add_ps(_mm_mul_ps(m10, pz), m14)));
+	}
+	TransformPointsScalar(m, x, y, z, outX, outY, outZ, i, count);
+}
+
+static void MultiplyMatricesSSE2(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const float* l = a[i].m;
+		const float* r = b[i].m;
+		__m128 c0 = _mm_load_ps(l), c1 = _mm_load_ps(l + 4), c2 = _mm_load_ps(l + 8), c3 = _mm_load_ps(l + 12);
+		__m128 result[4];
+		for (int column = 0; column < 4; column++)
+		{
+			const float* rc = r + column * 4;
+			result[column] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(rc[0])), _mm_mul_ps(c1, _mm_set1_ps(rc[1]))),
+				_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(rc[2])), _mm_mul_ps(c3, _mm_set1_ps(rc[3]))));
+		}
+		// Stores last so out may alias a or b
+		for (int column = 0; column < 4; column++)
+			_mm_store_ps(out[i].m + column * 4, result[column]);
+	}
+}
+
+static void TransformBoundsSSE2(const Mat4* transforms, const Aabb* local, Aabb* world, unsigned int count)
+{
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const float* m = transforms[i].m;
+		const Aabb& box = local[i];
+		__m128 min = _mm_setr_ps(box.min[0], box.min[1], box.min[2], 0.0f);
+		__m128 max = _mm_setr_ps(box.max[0], box.max[1], box.max[2], 0.0f);
+		__m128 center = _mm_mul_ps(_mm_add_ps(min, max), half);
+		__m128 extent = _mm_mul_ps(_mm_sub_ps(max, min), half);
+
+		// Same as the scalar version, one matrix column per component instead of one row per axis
+		// The components are broadcast with shuffles so center and extent never leave the registers
+		__m128 c0 = _mm_load_ps(m), c1 = _mm_load_ps(m + 4), c2 = _mm_load_ps(m + 8), c3 = _mm_load_ps(m + 12);
+		__m128 newCenter = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0))),
+			_mm_mul_ps(c1, _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1)))),
+			_mm_add_ps(_mm_mul_ps(c2, _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2))), c3));
+		__m128 newExtent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(c0, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(0, 0, 0, 0))),
+			_mm_mul_ps(_mm_and_ps(c1, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(1, 1, 1, 1)))),
+			_mm_mul_ps(_mm_and_ps(c2, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(2, 2, 2, 2))));
+
+		float lower[4], upper[4];
+		_mm_storeu_ps(lower, _mm_sub_ps(newCenter, newExtent));
+		_mm_storeu_ps(upper, _mm_add_ps(newCenter, newExtent));
+		for (int k = 0; k < 3; k++)
+		{
+			world[i].min[k] = lower[k];
+			world[i].max[k] = upper[k];
+		}
+	}
+}
+
+static void TransformBoundsSoASSE2(const Mat4* transforms, const AabbSoA& local, AabbSoA& world, unsigned int count)
+{
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 half = _mm_set1_ps(0.5f);
+	unsigned int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// Transposing the same column of 4 matrices gives one register per matrix element, one lane per box
+		__m128 m[16];
+		for (int column = 0; column < 4; column++)
+		{
+			__m128 r0 = _mm_load_ps(transforms[i].m + column * 4), r1 = _mm_load_ps(transforms[i + 1].m + column * 4);
+			__m128 r2 = _mm_load_ps(transforms[i + 2].m + column * 4), r3 = _mm_load_ps(transforms[i + 3].m + column * 4);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			m[column * 4] = r0; m[column * 4 + 1] = r1; m[column * 4 + 2] = r2; m[column * 4 + 3] = r3;
+		}
+
+		__m128 center[3], extent[3];
+		for (int k = 0; k < 3; k++)
+		{
+			__m128 min = _mm_loadu_ps(&local.min[k][i]), max = _mm_loadu_ps(&local.max[k][i]);
+			center[k] = _mm_mul_ps(_mm_add_ps(min, max), half);
+			extent[k] = _mm_mul_ps(_mm_sub_ps(max, min), half);
+		}
+
+		for (int row = 0; row < 3; row++)
+		{
+			__m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[row], center[0]), _mm_mul_ps(m[4 + row], center[1])),
+				_mm_add_ps(_mm_mul_ps(m[8 + row], center[2]), m[12 + row]));
+			__m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(m[row], absMask), extent[0]), _mm_mul_ps(_mm_and_ps(m[4 + row], absMask), extent[1])),
+				_mm_mul_ps(_mm_and_ps(m[8 + row], absMask), extent[2]));
+			_mm_storeu_ps(&world.min[row][i], _mm_sub_ps(c, e));
+			_mm_storeu_ps(&world.max[row][i], _mm_add_ps(c, e));
+		}
+	}
+	TransformBoundsSoAScalar(transforms, local, world, i, count);
+}
+#define MATH_KERNELS_SSE2
+#endif
+
+#ifdef MATH_KERNELS_X64
+// ---- AVX2 with FMA, 8 points per step ----
+
+MATH_KERNELS_AVX2_TARGET
+static void TransformPointsAVX2(const float* m, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count)
+{
+	__m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+	__m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6 = _mm256_set1_ps(m[6]);
+	__m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]);
+	__m256 m12 = _mm256_set1_ps(m[12]), m13 = _mm256_set1_ps(m[13]), m14 = _mm256_set1_ps(m[14]);
+
+	unsigned int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+		_mm256_storeu_ps(outX + i, _mm256_fmadd_ps(m0, px, _mm256_fmadd_ps(m4, py, _mm256_fmadd_ps(m8, pz, m12))));
+		_mm256_storeu_ps(outY + i, _mm256_fmadd_ps(m1, px, _mm256_fmadd_ps(m5, py, _mm256_fmadd_ps(m9, pz, m13))));
+		_mm256_storeu_ps(outZ + i, _mm256_fmadd_ps(m2, px, _mm256_fmadd_ps(m6, py, _mm256_fmadd_ps(m10, pz, m14))));
+	}
+	TransformPointsScalar(m, x, y, z, outX, outY, outZ, i, count);
+}
+
+MATH_KERNELS_AVX2_TARGET
+static void MultiplyMatricesAVX2(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const float* l = a[i].m;
+		const float* r = b[i].m;
+		// Two result columns per register, the left matrix columns duplicated into both halves
+		__m256 c0 = _mm256_broadcast_ps((const __m128*)l), c1 = _mm256_broadcast_ps((const __m128*)(l + 4));
+		__m256 c2 = _mm256_broadcast_ps((const __m128*)(l + 8)), c3 = _mm256_broadcast_ps((const __m128*)(l + 12));
+		__m256 result[2];
+		for (int pair = 0; pair < 2; pair++)
+		{
+			const float* r0 = r + pair * 8;
+			const float* r1 = r0 + 4;
+			__m256 w0 = _mm256_setr_ps(r0[0], r0[0], r0[0], r0[0], r1[0], r1[0], r1[0], r1[0]);
+			__m256 w1 = _mm256_setr_ps(r0[1], r0[1], r0[1], r0[1], r1[1], r1[1], r1[1], r1[1]);
+			__m256 w2 = _mm256_setr_ps(r0[2], r0[2], r0[2], r0[2], r1[2], r1[2], r1[2], r1[2]);
+			__m256 w3 = _mm256_setr_ps(r0[3], r0[3], r0[3], r0[3], r1[3], r1[3], r1[3], r1[3]);
+			result[pair] = _mm256_fmadd_ps(c0, w0, _mm256_fmadd_ps(c1, w1, _mm256_fmadd_ps(c2, w2, _mm256_mul_ps(c3, w3))));
+		}
+		_mm256_storeu_ps(out[i].m, result[0]);
+		_mm256_storeu_ps(out[i].m + 8, result[1]);
+	}
+}
+
+MATH_KERNELS_AVX2_TARGET
+static void TransformBoundsSoAAVX2(const Mat4* transforms, const AabbSoA& local, AabbSoA& world, unsigned int count)
+{
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+	const __m256 half = _mm256_set1_ps(0.5f);
+	// Float offsets of the same element in 8 consecutive matrices
+	const int stride = (int)(sizeof(Mat4) / sizeof(float));
+	const __m256i matrixOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	unsigned int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		// Gather each element the kernel uses from the 8 matrices, the bottom row is never needed
+		const float* base = transforms[i].m;
+		__m256 m[16];
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 3; row++)
+				m[column * 4 + row] = _mm256_i32gather_ps(base + column * 4 + row, matrixOffsets, 4);
+		}
+
+		__m256 center[3], extent[3];
+		for (int k = 0; k < 3; k++)
+		{
+			__m256 min = _mm256_loadu_ps(&local.min[k][i]), max = _mm256_loadu_ps(&local.max[k][i]);
+			center[k] = _mm256_mul_ps(_mm256_add_ps(min, max), half);
+			extent[k] = _mm256_mul_ps(_mm256_sub_ps(max, min), half);
+		}
+
+		for (int row = 0; row < 3; row++)
+		{
+			__m256 c = _mm256_fmadd_ps(m[row], center[0], _mm256_fmadd_ps(m[4 + row], center[1], _mm256_fmadd_ps(m[8 + row], center[2], m[12 + row])));
+			__m256 e = _mm256_fmadd_ps(_mm256_and_ps(m[row], absMask), extent[0], _mm256_fmadd_ps(_mm256_and_ps(m[4 + row], absMask), extent[1],
+				_mm256_mul_ps(_mm256_and_ps(m[8 + row], absMask), extent[2])));
+			_mm256_storeu_ps(&world.min[row][i], _mm256_sub_ps(c, e));
+			_mm256_storeu_ps(&world.max[row][i], _mm256_add_ps(c, e));
+		}
+	}
+	TransformBoundsSoAScalar(transforms, local, world, i, count);
+}
+#endif
+
+void TransformPoints(const Mat4& transform, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count)
+{
+	switch (GetSimdLevel())
+	{
+#ifdef MATH_KERNELS_X64
+		case SimdLevel::AVX2: TransformPointsAVX2(transform.m, x, y, z, outX, outY, outZ, count); return;
+#endif
+#ifdef MATH_KERNELS_SSE2
+		case SimdLevel::SSE2: TransformPointsSSE2(transform.m, x, y, z, outX, outY, outZ, count); return;
+#endif
+		default: TransformPointsScalar(transform.m, x, y, z, outX, outY, outZ, 0, count); return;
+	}
+}
+
+void MultiplyMatrices(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count)
+{
+	switch (GetSimdLevel())
+	{
+#ifdef MATH_KERNELS_X64
+		case SimdLevel::AVX2: MultiplyMatricesAVX2(a, b, out, count); return;
+#endif
+#ifdef MATH_KERNELS_SSE2
+		case SimdLevel::SSE2: MultiplyMatricesSSE2(a, b, out, count); return;
+#endif
+		default: MultiplyMatricesScalar(a, b, out, count); return;
+	}
+}
+
+void TransformBounds(const Mat4* transforms, const Aabb* local, Aabb* world, unsigned int count)
+{
+	// One box is too little work for 8 lanes, AVX2 runs the SSE2 version here
+	switch (GetSimdLevel())
+	{
+#ifdef MATH_KERNELS_SSE2
+		case SimdLevel::AVX2:
+		case SimdLevel::SSE2: TransformBoundsSSE2(transforms, local, world, count); return;
+#endif
+		default: TransformBoundsScalar(transforms, local, world, count); return;
+	}
+}
+
+void AabbSoA::Resize(unsigned int count)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		min[k].resize(count);
+		max[k].resize(count);
+	}
+}
+
+void TransformBounds(const Mat4* transforms, const AabbSoA& local, AabbSoA& world)
+{
+	unsigned int count = local.GetCount();
+	world.Resize(count);
+	switch (GetSimdLevel())
+	{
+#ifdef MATH_KERNELS_X64
+		case SimdLevel::AVX2: TransformBoundsSoAAVX2(transforms, local, world, count); return;
+#endif
+#ifdef MATH_KERNELS_SSE2
+		case SimdLevel::SSE2: TransformBoundsSoASSE2(transforms, local, world, count); return;
+#endif
+		default: TransformBoundsSoAScalar(transforms, local, world, 0, count); return;
+	}
+}
+
+// Best of a few runs in milliseconds, the first run also warms the caches
+static double TimeKernel(const std::function<void()>& kernel)
+{
+	double best = 1e30;
+	for (int run = 0; run < 5; run++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		kernel();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+void BenchmarkMathKernels(std::ostream& stream, unsigned int count)
+{
+	// Inputs only have to be finite and varied, the kernels do the same work whatever the values
+	std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count);
+	std::vector<Mat4> a(count), b(count), product(count);
+	std::vector<Aabb> local(count), world(count);
+	AabbSoA localSoA, worldSoA;
+	localSoA.Resize(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		x[i] = (float)(i % 97); y[i] = (float)(i % 89); z[i] = (float)(i % 83);
+		for (int k = 0; k < 16; k++)
+		{
+			a[i].m[k] = (float)((i + k) % 7) * 0.25f;
+			b[i].m[k] = (float)((i * 3 + k) % 5) * 0.5f;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			local[i].min[k] = localSoA.min[k][i] = -(float)((i + k) % 11);
+			local[i].max[k] = localSoA.max[k][i] = (float)((i + k) % 13);
+		}
+	}
+
+	struct Kernel
+	{
+		const char* name;
+		std::function<void()> run;
+	};
+	const Kernel kernels[] = {
+		{ "TransformPoints", [&]() { TransformPoints(a[0], x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count); } },
+		{ "MultiplyMatrices", [&]() { MultiplyMatrices(a.data(), b.data(), product.data(), count); } },
+		{ "TransformBounds", [&]() { TransformBounds(a.data(), local.data(), world.data(), count); } },
+		{ "TransformBounds SoA", [&]() { TransformBounds(a.data(), localSoA, worldSoA); } },
+	};
+
+	// Every level up to the detected one, each compared against scalar, then the level the caller had is restored
+	SimdLevel previous = GetSimdLevel();
+	SimdLevel best = DetectSimdLevel();
+	stream << "[Math Kernels] " << count << " elements, best of 5 runs" << std::endl;
+	for (const Kernel& kernel : kernels)
+	{
+		SetSimdLevel(SimdLevel::Scalar);
+		double scalar = TimeKernel(kernel.run);
+		stream << "    " << kernel.name << ": Scalar " << scalar << " ms";
+		for (int level = (int)SimdLevel::SSE2; level <= (int)best; level++)
+		{
+			SetSimdLevel((SimdLevel)level);
+			double time = TimeKernel(kernel.run);
+			stream << ", " << GetSimdLevelName((SimdLevel)level) << " " << time << " ms (" << scalar / time << "x)";
+		}
+		stream << std::endl;
+	}
+	SetSimdLevel(previous);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "SimdMath.h"
+
+struct Aabb;
+
+// Instruction sets the batch kernels can run on, picked at runtime from cpuid
+enum class SimdLevel
+{
+	Scalar = 0, SSE2, AVX2
+};
+
+// Best level this CPU and OS support, AVX2 also needs FMA, F16C and the OS saving the ymm registers
+SimdLevel DetectSimdLevel();
+inline const char* GetSimdLevelName(SimdLevel level)
+{
+	return level == SimdLevel::AVX2 ? "AVX2" : level == SimdLevel::SSE2 ? "SSE2" : "Scalar";
+}
+
+// Level the kernels below run at, the detected one unless lowered, which is how to time them against scalar
+SimdLevel GetSimdLevel();
+// Requests above what the CPU supports are clamped to it
+void SetSimdLevel(SimdLevel level);
+
+// Affine transform of count points held as structure of arrays, output arrays may alias the inputs
+void TransformPoints(const Mat4& transform, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, unsigned int count);
+
+// out[i] = a[i] * b[i]
+void MultiplyMatrices(const Mat4* a, const Mat4* b, Mat4* out, unsigned int count);
+
+// World space bounds of count local boxes under their transforms (Arvo 1990), ready for BoundingVolumeHierarchy::Update
+void TransformBounds(const Mat4* transforms, const Aabb* local, Aabb* world, unsigned int count);
+
+// Boxes as structure of arrays, min[axis][box] and max[axis][box], so a register holds the same bound of several boxes
+struct AabbSoA
+{
+	std::vector<float> min[3], max[3];
+
+	void Resize(unsigned int count);
+	inline unsigned int GetCount() const { return (unsigned int)min[0].size(); }
+};
+
+// Same transform for boxes held as structure of arrays, one transform per box, world is resized to match and may be local
+void TransformBounds(const Mat4* transforms, const AabbSoA& local, AabbSoA& world);
+
+// Time every kernel above on count elements at each level this CPU supports against scalar and write the speedups
+// Switches the level with SetSimdLevel while it runs and restores the previous one at the end
+void BenchmarkMathKernels(std::ostream& stream, unsigned int count = 100000);
\ No newline at end of file
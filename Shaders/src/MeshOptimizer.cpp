@@ -0,0 +1,368 @@
+#include "MeshOptimizer.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize)
+{
+	// A vertex is in the cache while fewer than cacheSize misses have happened since it was loaded
+	std::vector<unsigned int> loadedAt(vertexCount, 0);
+	unsigned int timestamp = cacheSize + 1;
+	unsigned int misses = 0;
+
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int index = indices[i];
+		ASSERT(index < vertexCount);
+		if (timestamp - loadedAt[index] > cacheSize)
+		{
+			loadedAt[index] = timestamp++;
+			misses++;
+		}
+	}
+
+	unsigned int usedVertices = 0;
+	for (unsigned int i = 0; i < vertexCount; i++)
+		if (loadedAt[i] != 0) usedVertices++;
+
+	VertexCacheStats stats;
+	stats.vertexTransforms = misses;
+	stats.acmr = indexCount ? (float)misses / (indexCount / 3) : 0.0f;
+	stats.atvr = usedVertices ? (float)misses / usedVertices : 0.0f;
+	return stats;
+}
+
+// FNV-1a over the raw bytes of one vertex
+static size_t HashVertex(const unsigned char* vertex, unsigned int vertexSize)
+{
+	size_t hash = 2166136261u;
+	for (unsigned int i = 0; i < vertexSize; i++)
+		hash = (hash ^ vertex[i]) * 16777619u;
+	return hash;
+}
+
+unsigned int GenerateVertexRemap(unsigned int* remap, const unsigned int* indices, unsigned int indexCount,
+	const void* vertices, unsigned int vertexCount, unsigned int vertexSize)
+{
+	const unsigned char* bytes = (const unsigned char*)vertices;
+	std::fill(remap, remap + vertexCount, 0xFFFFFFFF);
+
+	// Open addressing table of vertex indices, kept at most half full
+	size_t tableSize = 1;
+	while (tableSize < (size_t)vertexCount * 2)
+		tableSize *= 2;
+	std::vector<unsigned int> table(tableSize, 0xFFFFFFFF);
+
+	unsigned int uniqueCount = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int index = indices[i];
+		ASSERT(index < vertexCount);
+		if (remap[index] != 0xFFFFFFFF)
+			continue;
+
+		const unsigned char* vertex = bytes + (size_t)index * vertexSize;
+		size_t slot = HashVertex(vertex, vertexSize) & (tableSize - 1);
+		while (table[slot] != 0xFFFFFFFF && memcmp(bytes + (size_t)table[slot] * vertexSize, vertex, vertexSize) != 0)
+			slot = (slot + 1) & (tableSize - 1);
+
+		if (table[slot] == 0xFFFFFFFF)
+		{
+			// First time we see these bytes, it gets the next output slot
+			table[slot] = index;
+			remap[index] = uniqueCount++;
+		}
+		else
+		{
+			remap[index] = remap[table[slot]];
+		}
+	}
+
+	return uniqueCount;
+}
+
+void RemapVertexBuffer(void* destination, const void* vertices, unsigned int vertexCount, unsigned int vertexSize, const unsigned int* remap)
+{
+	for (unsigned int i = 0; i < vertexCount; i++)
+		if (remap[i] != 0xFFFFFFFF)
+			memcpy((unsigned char*)destination + (size_t)remap[i] * vertexSize, (const unsigned char*)vertices + (size_t)i * vertexSize, vertexSize);
+}
+
+void RemapIndexBuffer(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, const unsigned int* remap)
+{
+	for (unsigned int i = 0; i < indexCount; i++)
+		destination[i] = remap[indices[i]];
+}
+
+// Vertex -> triangle adjacency stored as one flat array
+struct TriangleAdjacency
+{
+	std::vector<unsigned int> counts; // Triangles using each vertex
+	std::vector<unsigned int> offsets; // Where each vertex's list starts in data
+	std::vector<unsigned int> data;
+
+	TriangleAdjacency(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount)
+		: counts(vertexCount, 0), offsets(vertexCount, 0), data(indexCount)
+	{
+		for (unsigned int i = 0; i < indexCount; i++)
+			counts[indices[i]]++;
+
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			offsets[i] = offset;
+			offset += counts[i];
+		}
+
+		std::vector<unsigned int> fill = offsets;
+		for (unsigned int i = 0; i < indexCount; i++)
+			data[fill[indices[i]]++] = i / 3;
+	}
+};
+
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize)
+{
+	ASSERT(indexCount % 3 == 0);
+	ASSERT(destination != indices);
+
+	unsigned int triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return;
+
+	TriangleAdjacency adjacency(indices, indexCount, vertexCount);
+	std::vector<unsigned int> liveTriangles = adjacency.counts; // Triangles not yet emitted per vertex
+	std::vector<unsigned int> cacheTime(vertexCount, 0); // When each vertex last entered the cache
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd; // Recently used vertices to restart from when we run out of neighbours
+	std::vector<unsigned int> candidates;
+
+	unsigned int timestamp = cacheSize + 1;
+	unsigned int cursor = 1; // Next vertex to try when the dead end stack is exhausted
+	unsigned int outputCount = 0;
+	int fanning = 0; // Vertex we are currently emitting a fan around
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		unsigned int begin = adjacency.offsets[fanning];
+		unsigned int end = begin + adjacency.counts[fanning];
+		for (unsigned int a = begin; a < end; a++)
+		{
+			unsigned int triangle = adjacency.data[a];
+			if (emitted[triangle])
+				continue;
+
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				unsigned int vertex = indices[triangle * 3 + k];
+				destination[outputCount++] = vertex;
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (timestamp - cacheTime[vertex] > cacheSize)
+					cacheTime[vertex] = timestamp++;
+			}
+			emitted[triangle] = true;
+		}
+
+		// Pick the candidate that will still be in the cache after its remaining fan is emitted, preferring the oldest
+		int best = -1;
+		int bestPriority = -1;
+		for (unsigned int vertex : candidates)
+		{
+			if (liveTriangles[vertex] == 0)
+				continue;
+
+			int priority = 0;
+			if (timestamp - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+				priority = timestamp - cacheTime[vertex];
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+
+		// Dead end, fall back to the most recently used vertex that still has work, then to input order
+		while (best == -1 && !deadEnd.empty())
+		{
+			unsigned int vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[vertex] > 0)
+				best = vertex;
+		}
+		while (best == -1 && cursor < vertexCount)
+		{
+			if (liveTriangles[cursor] > 0)
+				best = cursor;
+			cursor++;
+		}
+
+		fanning = best;
+	}
+
+	ASSERT(outputCount == indexCount);
+}
+
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int vertexCount, unsigned int positionStride, unsigned int cacheSize)
+{
+	ASSERT(indexCount % 3 == 0);
+	ASSERT(destination != indices);
+
+	unsigned int triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Split wherever the cache had to start from scratch, that keeps the cache efficiency inside each cluster
+	std::vector<unsigned int> clusterStarts;
+	std::vector<unsigned int> cacheTime(vertexCount, 0);
+	unsigned int timestamp = cacheSize + 1;
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		unsigned int misses = 0;
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			unsigned int vertex = indices[t * 3 + k];
+			if (timestamp - cacheTime[vertex] > cacheSize)
+			{
+				cacheTime[vertex] = timestamp++;
+				misses++;
+			}
+		}
+		if (t == 0 || misses == 3)
+			clusterStarts.push_back(t);
+	}
+	clusterStarts.push_back(triangleCount);
+
+	auto position = [&](unsigned int vertex) {
+		return (const float*)((const unsigned char*)positions + (size_t)vertex * positionStride);
+	};
+
+	// Area weighted centroid and normal for every cluster, and the centroid of the whole mesh
+	unsigned int clusterCount = (unsigned int)clusterStarts.size() - 1;
+	std::vector<float> clusterData(clusterCount * 6, 0.0f);
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (unsigned int c = 0; c < clusterCount; c++)
+	{
+		float* centroid = &clusterData[c * 6];
+		float* normal = centroid + 3;
+		float clusterArea = 0.0f;
+		for (unsigned int t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+		{
+			const float* p0 = position(indices[t * 3 + 0]);
+			const float* p1 = position(indices[t * 3 + 1]);
+			const float* p2 = position(indices[t * 3 + 2]);
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+				normal[k] += n[k];
+			}
+			clusterArea += area;
+		}
+
+		for (unsigned int k = 0; k < 3; k++)
+			meshCentroid[k] += centroid[k];
+		meshArea += clusterArea;
+
+		if (clusterArea > 0.0f)
+			for (unsigned int k = 0; k < 3; k++)
+				centroid[k] /= clusterArea;
+	}
+	if (meshArea > 0.0f)
+		for (unsigned int k = 0; k < 3; k++)
+			meshCentroid[k] /= meshArea;
+
+	// Clusters that face away from the centre are on the outside of the mesh, draw those first
+	std::vector<float> sortKeys(clusterCount);
+	for (unsigned int c = 0; c < clusterCount; c++)
+	{
+		const float* centroid = &clusterData[c * 6];
+		const float* normal = centroid + 3;
+		float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		float dot = 0.0f;
+		for (unsigned int k = 0; k < 3; k++)
+			dot += (centroid[k] - meshCentroid[k]) * normal[k];
+		sortKeys[c] = length > 0.0f ? dot / length : 0.0f;
+	}
+
+	std::vector<unsigned int> order(clusterCount);
+	for (unsigned int c = 0; c < clusterCount; c++)
+		order[c] = c;
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+	unsigned int outputCount = 0;
+	for (unsigned int c : order)
+	{
+		unsigned int first = clusterStarts[c] * 3;
+		unsigned int last = clusterStarts[c + 1] * 3;
+		for (unsigned int i = first; i < last; i++)
+			destination[outputCount++] = indices[i];
+	}
+}
+
+unsigned int OptimizeVertexFetch(void* destination, unsigned int* indices, unsigned int indexCount,
+	const void* vertices, unsigned int vertexCount, unsigned int vertexSize)
+{
+	ASSERT(destination != vertices);
+
+	// Hand out new slots in the order the indices first reference each vertex
+	std::vector<unsigned int> remap(vertexCount, 0xFFFFFFFF);
+	unsigned int nextVertex = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int index = indices[i];
+		ASSERT(index < vertexCount);
+		if (remap[index] == 0xFFFFFFFF)
+		{
+			memcpy((unsigned char*)destination + (size_t)nextVertex * vertexSize, (const unsigned char*)vertices + (size_t)index * vertexSize, vertexSize);
+			remap[index] = nextVertex++;
+		}
+		indices[i] = remap[index];
+	}
+
+	return nextVertex;
+}
+
+MeshOptimizationReport OptimizeMesh(std::vector<unsigned char>& vertices, std::vector<unsigned int>& indices,
+	unsigned int vertexSize, unsigned int positionOffset, unsigned int cacheSize)
+{
+	unsigned int vertexCount = (unsigned int)(vertices.size() / vertexSize);
+	unsigned int indexCount = (unsigned int)indices.size();
+
+	MeshOptimizationReport report;
+	report.originalVertexCount = vertexCount;
+	report.before = AnalyzeVertexCache(indices.data(), indexCount, vertexCount, cacheSize);
+
+	// Merge duplicate vertices
+	std::vector<unsigned int> remap(vertexCount);
+	unsigned int uniqueCount = GenerateVertexRemap(remap.data(), indices.data(), indexCount, vertices.data(), vertexCount, vertexSize);
+	std::vector<unsigned char> uniqueVertices((size_t)uniqueCount * vertexSize);
+	RemapVertexBuffer(uniqueVertices.data(), vertices.data(), vertexCount, vertexSize, remap.data());
+	RemapIndexBuffer(indices.data(), indices.data(), indexCount, remap.data());
+
+	// Triangle order for the vertex cache, then cluster order for overdraw
+	std::vector<unsigned int> scratch(indexCount);
+	OptimizeVertexCache(scratch.data(), indices.data(), indexCount, uniqueCount, cacheSize);
+	OptimizeOverdraw(indices.data(), scratch.data(), indexCount,
+		(const float*)(uniqueVertices.data() + positionOffset), uniqueCount, vertexSize, cacheSize);
+
+	// Finally lay the vertices out in the order they get fetched
+	vertices.resize((size_t)uniqueCount * vertexSize);
+	unsigned int finalCount = OptimizeVertexFetch(vertices.data(), indices.data(), indexCount, uniqueVertices.data(), uniqueCount, vertexSize);
+	vertices.resize((size_t)finalCount * vertexSize);
+
+	report.optimizedVertexCount = finalCount;
+	report.after = AnalyzeVertexCache(indices.data(), indexCount, finalCount, cacheSize);
+	return report;
+}
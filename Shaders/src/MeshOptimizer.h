@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+// Post transform vertex cache efficiency of an index buffer
+struct VertexCacheStats
+{
+	unsigned int vertexTransforms; // How many times the vertex shader runs with a FIFO cache
+	float acmr; // Average cache miss ratio, transforms per triangle (0.5 is ideal for big grids, 3 is the worst)
+	float atvr; // Average transform to vertex ratio (1 is ideal)
+};
+
+// Before/after numbers from OptimizeMesh
+struct MeshOptimizationReport
+{
+	unsigned int originalVertexCount;
+	unsigned int optimizedVertexCount;
+	VertexCacheStats before;
+	VertexCacheStats after;
+};
+
+// Simulate a FIFO post transform cache of cacheSize entries over a triangle list
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+// Build a table mapping each vertex to the first vertex with identical bytes, returns the number of unique vertices
+// remap must hold vertexCount entries, unreferenced vertices are mapped to 0xFFFFFFFF
+unsigned int GenerateVertexRemap(unsigned int* remap, const unsigned int* indices, unsigned int indexCount,
+	const void* vertices, unsigned int vertexCount, unsigned int vertexSize);
+// Apply a remap table from GenerateVertexRemap to the vertices and the indices
+void RemapVertexBuffer(void* destination, const void* vertices, unsigned int vertexCount, unsigned int vertexSize, const unsigned int* remap);
+void RemapIndexBuffer(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, const unsigned int* remap);
+
+// Reorder triangles for the post transform cache with Tipsify (Sander et al. 2007)
+// destination must not alias indices
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+// Reorder cache friendly clusters of triangles so outward facing ones are drawn first and occlude the rest
+// positions points at the first float3 position, positionStride is the size in bytes of one vertex
+// Run this after OptimizeVertexCache, destination must not alias indices
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int vertexCount, unsigned int positionStride, unsigned int cacheSize = 16);
+
+// Reorder vertices into the order the index buffer first uses them, rewriting the indices in place
+// Unused vertices are dropped, returns the new vertex count
+unsigned int OptimizeVertexFetch(void* destination, unsigned int* indices, unsigned int indexCount,
+	const void* vertices, unsigned int vertexCount, unsigned int vertexSize);
+
+// Run every stage above on a triangle list before it goes into a VertexBuffer/IndexBuffer
+// positionOffset is the byte offset of the float3 position inside each vertex
+MeshOptimizationReport OptimizeMesh(std::vector<unsigned char>& vertices, std::vector<unsigned int>& indices,
+	unsigned int vertexSize, unsigned int positionOffset, unsigned int cacheSize = 16);
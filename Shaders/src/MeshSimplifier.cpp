@@ -0,0 +1,263 @@
+#include "MeshSimplifier.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Symmetric 4x4 error quadric, stored as the 10 unique coefficients plus the summed weight of its planes
+struct Quadric
+{
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+	double weight;
+
+	void Add(const Quadric& q)
+	{
+		a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+		bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+		weight += q.weight;
+	}
+
+	// Squared distance sum to all accumulated planes for point p
+	double Evaluate(const float* p) const
+	{
+		double x = p[0], y = p[1], z = p[2];
+		return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+			+ b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+			+ c2 * z * z + 2.0 * cd * z + d2;
+	}
+};
+
+static Quadric PlaneQuadric(double a, double b, double c, double d, double weight)
+{
+	return { a * a * weight, a * b * weight, a * c * weight, a * d * weight, b * b * weight,
+		b * c * weight, b * d * weight, c * c * weight, c * d * weight, d * d * weight, weight };
+}
+
+static const float* PositionOf(const float* positions, unsigned int positionStride, unsigned int vertex)
+{
+	return (const float*)((const unsigned char*)positions + (size_t)vertex * positionStride);
+}
+
+static void TriangleNormal(const float* a, const float* b, const float* c, double* normal)
+{
+	double e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	double e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+	normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+	normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+float SimplifyMesh(std::vector<unsigned int>& destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int vertexCount, unsigned int positionStride, unsigned int targetIndexCount, float maxError)
+{
+	destination.assign(indices, indices + indexCount);
+
+	// Accumulate the area weighted plane quadric of every face on its three vertices
+	std::vector<Quadric> quadrics(vertexCount, Quadric{});
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		double normal[3];
+		const float* p0 = PositionOf(positions, positionStride, indices[i]);
+		TriangleNormal(p0, PositionOf(positions, positionStride, indices[i + 1]), PositionOf(positions, positionStride, indices[i + 2]), normal);
+		double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0)
+			continue;
+
+		double a = normal[0] / length, b = normal[1] / length, c = normal[2] / length;
+		double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+		Quadric quadric = PlaneQuadric(a, b, c, d, length * 0.5);
+		for (int k = 0; k < 3; k++)
+			quadrics[indices[i + k]].Add(quadric);
+	}
+
+	// An edge used by a single triangle is a border, packed as (min << 32) | max
+	std::vector<unsigned long long> edges;
+	edges.reserve(indexCount);
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int a = indices[i + k], b = indices[i + (k + 1) % 3];
+			edges.push_back(((unsigned long long)std::min(a, b) << 32) | std::max(a, b));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	std::vector<unsigned char> locked(vertexCount, 0);
+	for (size_t i = 0; i < edges.size();)
+	{
+		size_t j = i;
+		while (j < edges.size() && edges[j] == edges[i])
+			j++;
+		if (j - i == 1)
+		{
+			locked[(unsigned int)(edges[i] >> 32)] = 1;
+			locked[(unsigned int)edges[i]] = 1;
+		}
+		i = j;
+	}
+
+	struct Collapse
+	{
+		unsigned int from, to;
+		double cost; // Area weighted, so collapses among small triangles go first
+		double error; // Cost divided by the area, a squared distance in object space units
+	};
+
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<unsigned int> triangleOffsets(vertexCount + 1), triangleList;
+	std::vector<unsigned char> touched(vertexCount);
+	std::vector<Collapse> collapses;
+	double largestError = 0.0;
+	const double maxSquaredError = (double)maxError * maxError;
+
+	// Each pass collapses a batch of independent edges in order of cost, then rebuilds the triangle list
+	while (destination.size() > targetIndexCount)
+	{
+		unsigned int count = (unsigned int)destination.size();
+
+		// Vertex to triangle adjacency for the flip test
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (unsigned int i = 0; i < count; i++)
+			triangleOffsets[destination[i] + 1]++;
+		for (unsigned int v = 0; v < vertexCount; v++)
+			triangleOffsets[v + 1] += triangleOffsets[v];
+		triangleList.resize(count);
+		{
+			std::vector<unsigned int> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (unsigned int i = 0; i < count; i++)
+				triangleList[cursor[destination[i]]++] = i / 3;
+		}
+
+		// Price every edge in the cheaper of its collapse directions, locked vertices never move
+		collapses.clear();
+		for (unsigned int i = 0; i < count; i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int a = destination[i + k], b = destination[i + (k + 1) % 3];
+				if (a > b)
+					continue;
+
+				Quadric sum = quadrics[a];
+				sum.Add(quadrics[b]);
+				double costAB = locked[a] ? 1e300 : sum.Evaluate(PositionOf(positions, positionStride, b));
+				double costBA = locked[b] ? 1e300 : sum.Evaluate(PositionOf(positions, positionStride, a));
+				if (locked[a] && locked[b])
+					continue;
+				// Without the division the error would grow with the square of the mesh scale instead of linearly
+				double cost = std::max(std::min(costAB, costBA), 0.0);
+				double error = sum.weight > 0.0 ? cost / sum.weight : 0.0;
+				if (costAB <= costBA)
+					collapses.push_back({ a, b, cost, error });
+				else
+					collapses.push_back({ b, a, cost, error });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.cost < r.cost; });
+
+		for (unsigned int v = 0; v < vertexCount; v++)
+			remap[v] = v;
+		std::fill(touched.begin(), touched.end(), 0);
+
+		// Every collapse of an interior edge removes two triangles
+		unsigned int trianglesToRemove = (count - targetIndexCount) / 3;
+		unsigned int removed = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (removed >= trianglesToRemove)
+				break;
+			if (collapse.error > maxSquaredError)
+				continue;
+			if (touched[collapse.from] || touched[collapse.to])
+				continue;
+
+			// Reject the collapse if any surviving triangle around from would flip over or degenerate
+			const float* target = PositionOf(positions, positionStride, collapse.to);
+			bool flips = false;
+			unsigned int lost = 0;
+			for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && !flips; t++)
+			{
+				const unsigned int* triangle = &destination[triangleList[t] * 3];
+				if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+				{
+					lost++;
+					continue;
+				}
+
+				const float* corners[3];
+				const float* moved[3];
+				for (int k = 0; k < 3; k++)
+				{
+					corners[k] = PositionOf(positions, positionStride, triangle[k]);
+					moved[k] = triangle[k] == collapse.from ? target : corners[k];
+				}
+				double before[3], after[3];
+				TriangleNormal(corners[0], corners[1], corners[2], before);
+				TriangleNormal(moved[0], moved[1], moved[2], after);
+				// Normals turning by more than about 75 degrees count as a flip, that also catches triangles collapsing into slivers
+				double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+				double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+				flips = dot <= 0.25 * lengths;
+			}
+			if (flips)
+				continue;
+
+			// Neighbours of from are left alone for the rest of the pass so the flip test above stays valid
+			for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1]; t++)
+			{
+				const unsigned int* triangle = &destination[triangleList[t] * 3];
+				for (int k = 0; k < 3; k++)
+					touched[triangle[k]] = 1;
+			}
+
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to].Add(quadrics[collapse.from]);
+			largestError = std::max(largestError, collapse.error);
+			removed += lost;
+		}
+
+		if (removed == 0)
+			break;
+
+		// Apply the pass and drop the triangles that became degenerate
+		unsigned int write = 0;
+		for (unsigned int i = 0; i < count; i += 3)
+		{
+			unsigned int a = remap[destination[i]], b = remap[destination[i + 1]], c = remap[destination[i + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			destination[write++] = a;
+			destination[write++] = b;
+			destination[write++] = c;
+		}
+		destination.resize(write);
+	}
+
+	return (float)std::sqrt(largestError);
+}
+
+void GenerateLodChain(std::vector<unsigned int>& lodIndices, std::vector<LodLevel>& levels, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int vertexCount, unsigned int positionStride, unsigned int levelCount, float reduction)
+{
+	ASSERT(levelCount > 0);
+	lodIndices.assign(indices, indices + indexCount);
+	levels.clear();
+	levels.push_back({ 0, indexCount, 0, 0.0f });
+
+	// Simplify each level from the previous one, carrying the error forward since it only ever grows
+	std::vector<unsigned int> current(indices, indices + indexCount), simplified;
+	float error = 0.0f;
+	for (unsigned int level = 1; level < levelCount; level++)
+	{
+		unsigned int target = (unsigned int)(current.size() / 3 * reduction) * 3;
+		error = std::max(error, SimplifyMesh(simplified, current.data(), (unsigned int)current.size(), positions, vertexCount, positionStride, target));
+
+		// No progress means the locked border is all that is left, more levels would just repeat this one
+		if (simplified.size() >= current.size())
+			break;
+
+		levels.push_back({ (unsigned int)lodIndices.size(), (unsigned int)simplified.size(), 0, error });
+		lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+		current.swap(simplified);
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+// One level of detail, a range of a shared index buffer plus the geometric error it introduces in object space units
+struct LodLevel
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	int baseVertex;
+	float error;
+};
+
+// Reduce a triangle list towards targetIndexCount with quadric error edge collapses (Garland and Heckbert 1997)
+// Vertices only ever collapse onto another existing vertex, so every result indexes the original vertex buffer
+// Border vertices, which includes both sides of UV and normal seams, are locked to keep the outline and the seams intact
+// positions points at the first float3 position, positionStride is the size in bytes of one vertex
+// Skips collapses that would exceed maxError, returns the largest error introduced as an RMS distance in object space units
+float SimplifyMesh(std::vector<unsigned int>& destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int vertexCount, unsigned int positionStride, unsigned int targetIndexCount, float maxError = 1e30f);
+
+// Build levelCount levels at import time, each keeping reduction times the triangles of the one before
+// All levels are appended to lodIndices so they can share one IndexBuffer, level 0 is the full detail mesh
+void GenerateLodChain(std::vector<unsigned int>& lodIndices, std::vector<LodLevel>& levels, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int vertexCount, unsigned int positionStride, unsigned int levelCount, float reduction = 0.5f);
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "MultiDrawIndirect.h"
+#include "Renderer.h"
+#include "GpuMemory.h"
+
+MultiDrawIndirect::MultiDrawIndirect()
+	: m_NextInstance(0), m_CommandCount(0), m_IndirectBuffer(0), m_IndirectBufferCapacity(0)
+{
+	GLCall(glGenBuffers(1, &m_IndirectBuffer));
+}
+
+MultiDrawIndirect::~MultiDrawIndirect()
+{
+	GLCall(glDeleteBuffers(1, &m_IndirectBuffer));
+	GpuMemoryTracker::Get().Free(GpuMemoryCategory::Other, m_IndirectBufferCapacity * sizeof(DrawElementsIndirectCommand));
+}
+
+bool MultiDrawIndirect::IsSupported()
+{
+	// The base instance field of an indirect command must be 0 without base instance support
+	if (GLEW_VERSION_4_3)
+		return true;
+	return (GLEW_VERSION_4_0 || GLEW_ARB_draw_indirect) && GLEW_ARB_multi_draw_indirect && HasBaseInstance();
+}
+
+bool MultiDrawIndirect::HasBaseInstance()
+{
+	return GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+}
+
+void MultiDrawIndirect::Begin()
+{
+	// Keep the buckets around so their command vectors do not reallocate every frame
+	for (Bucket& bucket : m_Buckets)
+		bucket.commands.clear();
+	m_NextInstance = 0;
+	m_CommandCount = 0;
+}
+
+unsigned int MultiDrawIndirect::Add(unsigned int program, const GeometryPool& pool, unsigned int meshHandle, unsigned int instanceCount)
+{
+	unsigned long long key = ((unsigned long long)program << 32) | pool.GetVertexArray().GetRendererID();
+	auto it = m_BucketLookup.find(key);
+	if (it == m_BucketLookup.end())
+	{
+		it = m_BucketLookup.emplace(key, (unsigned int)m_Buckets.size()).first;
+		m_Buckets.push_back({ program, &pool, std::vector<DrawElementsIndirectCommand>() });
+	}
+
+	// Refresh the pool in case a new pool reused the vertex array name of an old one
+	Bucket& bucket = m_Buckets[it->second];
+	bucket.pool = &pool;
+
+	const MeshRange& range = pool.GetRange(meshHandle);
+	unsigned int baseInstance = m_NextInstance;
+	bucket.commands.push_back({ range.indexCount, instanceCount, range.indexOffset, (int)range.vertexOffset, baseInstance });
+
+	m_NextInstance += instanceCount;
+	m_CommandCount++;
+	return baseInstance;
+}
+
+void MultiDrawIndirect::Execute()
+{
+	if (m_CommandCount == 0)
+		return;
+
+	if (!IsSupported())
+	{
+		ExecuteSingleDraws();
+		return;
+	}
+
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer));
+
+	// Grow the buffer to fit the frame
+	if (m_CommandCount > m_IndirectBufferCapacity)
+	{
+		GpuMemoryTracker::Get().Free(GpuMemoryCategory::Other, m_IndirectBufferCapacity * sizeof(DrawElementsIndirectCommand));
+		m_IndirectBufferCapacity = m_CommandCount + m_CommandCount / 2;
+		GpuMemoryTracker::Get().Allocate(GpuMemoryCategory::Other, m_IndirectBufferCapacity * sizeof(DrawElementsIndirectCommand));
+	}
+	// Respecifying also orphans last frame's commands so we never wait on draws still reading them
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_IndirectBufferCapacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW));
+
+	// Every bucket's commands back to back
+
+	size_t offset = 0;
+	for (const Bucket& bucket : m_Buckets)
+	{
+		if (bucket.commands.empty())
+			continue;
+		size_t size = bucket.commands.size() * sizeof(DrawElementsIndirectCommand);
+		GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offset, size, bucket.commands.data()));
+		offset += size;
+	}
+
+	offset = 0;
+	for (const Bucket& bucket : m_Buckets)
+	{
+		if (bucket.commands.empty())
+			continue;
+
+		GLCall(glUseProgram(bucket.program));
+		bucket.pool->Bind();
+		GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)offset, (GLsizei)bucket.commands.size(), 0));
+		offset += bucket.commands.size() * sizeof(DrawElementsIndirectCommand);
+	}
+
+	GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
+
+void MultiDrawIndirect::ExecuteSingleDraws()
+{
+	// Same draws one at a time from the command vectors, so neither the indirect buffer target (GL 4.0)
+	// nor multi draw is needed. gl_DrawID will always be 0 on this path
+	bool baseInstance = HasBaseInstance();
+	for (const Bucket& bucket : m_Buckets)
+	{
+		if (bucket.commands.empty())
+			continue;
+
+		GLCall(glUseProgram(bucket.program));
+		bucket.pool->Bind();
+		if (baseInstance)
+		{
+			for (const DrawElementsIndirectCommand& command : bucket.commands)
+			{
+				GLCall(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+					(const void*)((size_t)command.firstIndex * sizeof(unsigned int)), command.instanceCount, command.baseVertex, command.baseInstance));
+			}
+			continue;
+		}
+
+		// GL 3.3 has no base instance at all, hand it to the shader through u_BaseObject instead
+		// Looked up every frame since the program name may have been reused by another program
+		GLCall(int location = glGetUniformLocation(bucket.program, "u_BaseObject"));
+		for (const DrawElementsIndirectCommand& command : bucket.commands)
+		{
+			if (location != -1)
+			{
+				GLCall(glUniform1i(location, (int)command.baseInstance));
+			}
+			GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+				(const void*)((size_t)command.firstIndex * sizeof(unsigned int)), command.instanceCount, command.baseVertex));
+		}
+		// Back to 0 for single draws made outside of this class
+		if (location != -1)
+		{
+			GLCall(glUniform1i(location, 0));
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "GeometryPool.h"
+
+// Layout the GPU reads for each draw of glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+// Batches draws of GeometryPool meshes into one glMultiDrawElementsIndirect per (program, pool)
+// Each draw gets a unique base instance, so shaders can find their per draw data with gl_BaseInstance
+// (or gl_DrawID inside a bucket), or through a per instance attribute fed from an identity buffer
+class MultiDrawIndirect
+{
+private:
+	struct Bucket
+	{
+		unsigned int program;
+		const GeometryPool* pool;
+		std::vector<DrawElementsIndirectCommand> commands;
+	};
+
+	std::vector<Bucket> m_Buckets;
+	std::unordered_map<unsigned long long, unsigned int> m_BucketLookup; // (program, vertex array) -> bucket
+	unsigned int m_NextInstance; // Base instance handed to the next draw
+	unsigned int m_CommandCount;
+	unsigned int m_IndirectBuffer; // GL_DRAW_INDIRECT_BUFFER holding every command of the frame, only filled with multi draw
+	unsigned int m_IndirectBufferCapacity; // In commands
+
+	void ExecuteSingleDraws();
+public:
+	MultiDrawIndirect();
+	~MultiDrawIndirect();
+
+	// Multi draw needs GL 4.3 (or the draw indirect, multi draw indirect and base instance extensions),
+	// otherwise Execute issues one draw per command straight from client memory
+	static bool IsSupported();
+	// Whether those single draws can pass the base instance, without it they set the u_BaseObject uniform
+	// of the program instead (see objects.shader) and gl_BaseInstance reads 0
+	static bool HasBaseInstance();
+
+	void Begin();
+	// Queue instanceCount copies of a pool mesh, returns the base instance this draw's per draw data lives at
+	unsigned int Add(unsigned int program, const GeometryPool& pool, unsigned int meshHandle, unsigned int instanceCount = 1);
+	// Upload every command and issue one multi draw per bucket, or fall back to single draws
+	void Execute();
+
+	inline unsigned int GetCommandCount() const { return m_CommandCount; }
+	inline unsigned int GetBucketCount() const { return (unsigned int)m_Buckets.size(); }
+};
\ No newline at end of file
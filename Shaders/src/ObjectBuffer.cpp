@@ -0,0 +1,70 @@
+#include "ObjectBuffer.h"
+#include "Renderer.h"
+#include "GpuMemory.h"
+
+ObjectBuffer::ObjectBuffer(unsigned int capacity)
+	: m_Buffer(0), m_Capacity(capacity)
+{
+	m_Records.reserve(capacity);
+	GLCall(glGenBuffers(1, &m_Buffer));
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffer));
+	GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, m_Capacity * sizeof(ObjectRecord), nullptr, GL_STREAM_DRAW));
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+	GpuMemoryTracker::Get().Allocate(GpuMemoryCategory::Other, m_Capacity * sizeof(ObjectRecord));
+}
+
+ObjectBuffer::~ObjectBuffer()
+{
+	GLCall(glDeleteBuffers(1, &m_Buffer));
+	GpuMemoryTracker::Get().Free(GpuMemoryCategory::Other, m_Capacity * sizeof(ObjectRecord));
+}
+
+bool ObjectBuffer::IsSupported()
+{
+	// The extension alone is not enough, objects.shader is written against #version 430
+	return GLEW_VERSION_4_3;
+}
+
+bool ObjectBuffer::HasDrawParameters()
+{
+	return GLEW_VERSION_4_6 || GLEW_ARB_shader_draw_parameters;
+}
+
+void ObjectBuffer::Begin()
+{
+	m_Records.clear();
+}
+
+unsigned int ObjectBuffer::Add(const ObjectRecord& record)
+{
+	m_Records.push_back(record);
+	return (unsigned int)m_Records.size() - 1;
+}
+
+void ObjectBuffer::Upload()
+{
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffer));
+
+	// Grow the buffer to fit the frame
+	unsigned int count = (unsigned int)m_Records.size();
+	if (count > m_Capacity)
+	{
+		GpuMemoryTracker::Get().Free(GpuMemoryCategory::Other, m_Capacity * sizeof(ObjectRecord));
+		m_Capacity = count + count / 2;
+		GpuMemoryTracker::Get().Allocate(GpuMemoryCategory::Other, m_Capacity * sizeof(ObjectRecord));
+	}
+	// Respecifying orphans last frame's records so we never wait on draws still reading them
+	GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, m_Capacity * sizeof(ObjectRecord), nullptr, GL_STREAM_DRAW));
+	if (count)
+	{
+		GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(ObjectRecord), m_Records.data()));
+	}
+	GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+	Bind();
+}
+
+void ObjectBuffer::Bind(unsigned int binding) const
+{
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_Buffer));
+}
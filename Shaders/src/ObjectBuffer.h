@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+// Per object data as the shader sees it, laid out for std430 so the array can be copied as is
+struct ObjectRecord
+{
+	float transform[16]; // Column major model view projection
+	float color[4];
+	unsigned int materialIndex;
+	unsigned int padding[3]; // std430 rounds the struct up to the 16 byte alignment of its vec4 members
+};
+
+static_assert(sizeof(ObjectRecord) == 96, "ObjectRecord must match the std430 layout in objects.shader");
+
+// One shader storage buffer of ObjectRecords rebuilt every frame and uploaded in one go
+// Shaders find their record with gl_BaseInstance + gl_InstanceID, so a draw of N instances reads N consecutive
+// records and a multi draw whose commands use the index from Add as base instance needs no per draw uniforms at all
+// Use with res/shaders/objects.shader
+class ObjectBuffer
+{
+private:
+	std::vector<ObjectRecord> m_Records;
+	unsigned int m_Buffer; // GL_SHADER_STORAGE_BUFFER
+	unsigned int m_Capacity; // In records
+public:
+	static const unsigned int DefaultBinding = 0; // Must match the binding of Objects in objects.shader
+
+	ObjectBuffer(unsigned int capacity = 1024);
+	~ObjectBuffer();
+
+	ObjectBuffer(const ObjectBuffer&) = delete;
+	ObjectBuffer& operator=(const ObjectBuffer&) = delete;
+
+	// Storage buffers and objects.shader need a GL 4.3 context
+	static bool IsSupported();
+	// Whether shaders can read gl_BaseInstanceARB, otherwise they fall back to the u_BaseObject uniform
+	static bool HasDrawParameters();
+
+	void Begin();
+	// Returns the record index, which is the base instance to draw the object with
+	unsigned int Add(const ObjectRecord& record);
+	inline ObjectRecord& GetRecord(unsigned int index) { return m_Records[index]; }
+
+	// Copy every record of this frame to the GPU and bind the buffer to binding
+	void Upload();
+	void Bind(unsigned int binding = DefaultBinding) const;
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Records.size(); }
+	inline unsigned int GetRendererID() const { return m_Buffer; }
+};
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "OcclusionCuller.h"
+#include "BoundingVolumeHierarchy.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OCCLUSION_CULLER_SSE
+#endif
+
+// Vertices closer than this in clip space w are treated as crossing the near plane
+static const float MinClipW = 1e-5f;
+// Give every band at least this many rows so it stays worth a task
+static const unsigned int MinRowsPerThread = 16;
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height, unsigned int threadCount)
+	: m_Width((width + 3) & ~3u), m_Height(height), m_ThreadCount(threadCount)
+{
+	// Rows are padded to a multiple of 4 so every SSE load and store stays inside its row
+	if (m_ThreadCount == 0)
+		m_ThreadCount = WorkerPool::Get().GetThreadCount();
+	m_ThreadCount = std::min(m_ThreadCount, std::max(1u, m_Height / MinRowsPerThread));
+
+	m_Depth.resize(m_Width * m_Height);
+	BeginFrame();
+}
+
+void OcclusionCuller::BeginFrame()
+{
+	std::fill(m_Depth.begin(), m_Depth.end(), 1.0f);
+	m_Triangles.clear();
+}
+
+// Column major matrix times (x, y, z, 1)
+static void TransformPoint(const float* m, const float* p, float* out)
+{
+	for (int k = 0; k < 4; k++)
+		out[k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+}
+
+void OcclusionCuller::AddOccluder(const void* vertices, unsigned int vertexSize, unsigned int positionOffset, unsigned int vertexCount,
+	const unsigned int* indices, unsigned int indexCount, const float* modelViewProjection)
+{
+	const unsigned char* bytes = (const unsigned char*)vertices;
+	const float halfWidth = m_Width * 0.5f, halfHeight = m_Height * 0.5f;
+
+	// Transform every vertex once, w <= 0 marks a vertex at or behind the eye
+	std::vector<float> screen(vertexCount * 4);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		float position[3], clip[4];
+		std::memcpy(position, bytes + i * vertexSize + positionOffset, sizeof(position));
+		TransformPoint(modelViewProjection, position, clip);
+
+		float* out = &screen[i * 4];
+		if (clip[3] < MinClipW)
+		{
+			out[3] = 0.0f;
+			continue;
+		}
+		float inverseW = 1.0f / clip[3];
+		out[0] = (clip[0] * inverseW + 1.0f) * halfWidth;
+		out[1] = (clip[1] * inverseW + 1.0f) * halfHeight;
+		out[2] = clip[2] * inverseW * 0.5f + 0.5f;
+		out[3] = 1.0f;
+	}
+
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		const float* v[3] = { &screen[indices[i] * 4], &screen[indices[i + 1] * 4], &screen[indices[i + 2] * 4] };
+		if (v[0][3] == 0.0f || v[1][3] == 0.0f || v[2][3] == 0.0f)
+			continue;
+
+		ScreenTriangle triangle;
+		for (int k = 0; k < 3; k++)
+		{
+			triangle.x[k] = v[k][0];
+			triangle.y[k] = v[k][1];
+			triangle.z[k] = v[k][2];
+		}
+
+		float minX = std::min(std::min(triangle.x[0], triangle.x[1]), triangle.x[2]);
+		float maxX = std::max(std::max(triangle.x[0], triangle.x[1]), triangle.x[2]);
+		float minY = std::min(std::min(triangle.y[0], triangle.y[1]), triangle.y[2]);
+		float maxY = std::max(std::max(triangle.y[0], triangle.y[1]), triangle.y[2]);
+		if (maxX < 0.0f || maxY < 0.0f || minX > (float)m_Width || minY > (float)m_Height)
+			continue;
+
+		m_Triangles.push_back(triangle);
+	}
+}
+
+void OcclusionCuller::Rasterize()
+{
+	if (m_ThreadCount == 1)
+	{
+		RasterizeBand(0, m_Height);
+		return;
+	}
+
+	// Bands never share a row, so the workers write the depth buffer without any synchronization
+	WorkerPool::Get().ParallelFor(m_ThreadCount, [this](unsigned int band) {
+		RasterizeBand(m_Height * band / m_ThreadCount, m_Height * (band + 1) / m_ThreadCount);
+	});
+}
+
+void OcclusionCuller::RasterizeBand(unsigned int rowBegin, unsigned int rowEnd)
+{
+	for (const ScreenTriangle& triangle : m_Triangles)
+		RasterizeTriangle(triangle, rowBegin, rowEnd);
+}
+
+void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& t, unsigned int rowBegin, unsigned int rowEnd)
+{
+	// Edge i is opposite vertex i, its function is positive inside a counter clockwise triangle
+	float area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.x[2] - t.x[0]) * (t.y[1] - t.y[0]);
+	if (area == 0.0f)
+		return;
+
+	// Occluders are double sided, flipping all edges handles clockwise triangles
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+	float edgeA[3], edgeB[3], edgeC[3];
+	for (int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3, k = (i + 2) % 3;
+		edgeA[i] = (t.y[j] - t.y[k]) * sign;
+		edgeB[i] = (t.x[k] - t.x[j]) * sign;
+		edgeC[i] = (t.x[j] * t.y[k] - t.x[k] * t.y[j]) * sign;
+	}
+
+	// Depth is affine in screen space: z = z0 + (z1 - z0) * e1 / area + (z2 - z0) * e2 / area
+	float inverseArea = sign / area;
+	float depthA = ((t.z[1] - t.z[0]) * edgeA[1] + (t.z[2] - t.z[0]) * edgeA[2]) * inverseArea;
+	float depthB = ((t.z[1] - t.z[0]) * edgeB[1] + (t.z[2] - t.z[0]) * edgeB[2]) * inverseArea;
+	float depthC = t.z[0] + ((t.z[1] - t.z[0]) * edgeC[1] + (t.z[2] - t.z[0]) * edgeC[2]) * inverseArea;
+
+	// Clamp in float before converting, a vertex just in front of the eye can project far outside the int range
+	int minX = (int)std::max(0.0f, std::min(std::min(t.x[0], t.x[1]), t.x[2]));
+	int maxX = (int)std::min((float)(m_Width - 1), std::max(std::max(t.x[0], t.x[1]), t.x[2]));
+	int minY = (int)std::max((float)rowBegin, std::min(std::min(t.y[0], t.y[1]), t.y[2]));
+	int maxY = (int)std::min((float)(rowEnd - 1), std::max(std::max(t.y[0], t.y[1]), t.y[2]));
+	if (minX > maxX || minY > maxY)
+		return;
+	minX &= ~3;
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		float* row = &m_Depth[y * m_Width];
+		float centerY = y + 0.5f;
+
+#if defined(OCCLUSION_CULLER_SSE)
+		// Evaluate everything at pixel centers for 4 neighbouring pixels at once
+		const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		__m128 edgeRow[3], edgeStep[3];
+		for (int i = 0; i < 3; i++)
+		{
+			edgeRow[i] = _mm_set1_ps(edgeB[i] * centerY + edgeC[i]);
+			edgeStep[i] = _mm_set1_ps(edgeA[i]);
+		}
+		__m128 depthRow = _mm_set1_ps(depthB * centerY + depthC);
+		__m128 depthStep = _mm_set1_ps(depthA);
+		const __m128 zero = _mm_setzero_ps();
+
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+			__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStep[0], pixelX), edgeRow[0]), zero);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStep[1], pixelX), edgeRow[1]), zero));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeStep[2], pixelX), edgeRow[2]), zero));
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(depthStep, pixelX), depthRow);
+			__m128 previous = _mm_loadu_ps(row + x);
+			__m128 closest = _mm_min_ps(previous, depth);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, previous)));
+		}
+#else
+		for (int x = minX; x <= maxX; x++)
+		{
+			float centerX = x + 0.5f;
+			bool inside = true;
+			for (int i = 0; i < 3; i++)
+				inside = inside && edgeA[i] * centerX + edgeB[i] * centerY + edgeC[i] >= 0.0f;
+			if (inside)
+				row[x] = std::min(row[x], depthA * centerX + depthB * centerY + depthC);
+		}
+#endif
+	}
+}
+
+bool OcclusionCuller::IsVisible(const Aabb& bounds, const float* viewProjection) const
+{
+	// Project all 8 corners and test the nearest depth of the box against its screen rectangle
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		float position[3] = {
+			(corner & 1) ? bounds.max[0] : bounds.min[0],
+			(corner & 2) ? bounds.max[1] : bounds.min[1],
+			(corner & 4) ? bounds.max[2] : bounds.min[2]
+		};
+		float clip[4];
+		TransformPoint(viewProjection, position, clip);
+
+		// A box reaching behind the eye covers an unbounded part of the screen, never cull it
+		if (clip[3] < MinClipW)
+			return true;
+
+		float inverseW = 1.0f / clip[3];
+		float x = (clip[0] * inverseW + 1.0f) * m_Width * 0.5f;
+		float y = (clip[1] * inverseW + 1.0f) * m_Height * 0.5f;
+		minX = std::min(minX, x); maxX = std::max(maxX, x);
+		minY = std::min(minY, y); maxY = std::max(maxY, y);
+		minZ = std::min(minZ, clip[2] * inverseW * 0.5f + 0.5f);
+	}
+
+	if (maxX < 0.0f || maxY < 0.0f || minX > (float)m_Width || minY > (float)m_Height)
+		return false;
+
+	// Same float clamp as in RasterizeTriangle, a corner with w just above MinClipW lands far past the int range
+	int beginX = (int)std::max(0.0f, minX), endX = (int)std::min((float)(m_Width - 1), maxX);
+	int beginY = (int)std::max(0.0f, minY), endY = (int)std::min((float)(m_Height - 1), maxY);
+
+	for (int y = beginY; y <= endY; y++)
+	{
+		const float* row = &m_Depth[y * m_Width];
+#if defined(OCCLUSION_CULLER_SSE)
+		const __m128i laneIndices = _mm_setr_epi32(0, 1, 2, 3);
+		const __m128 boxDepth = _mm_set1_ps(minZ);
+		for (int x = beginX & ~3; x <= endX; x += 4)
+		{
+			// Lanes left of beginX or right of endX belong to pixels outside the rectangle
+			__m128i lanes = _mm_add_epi32(_mm_set1_epi32(x), laneIndices);
+			__m128i inRange = _mm_andnot_si128(_mm_cmplt_epi32(lanes, _mm_set1_epi32(beginX)), _mm_cmplt_epi32(lanes, _mm_set1_epi32(endX + 1)));
+			__m128 notOccluded = _mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepth);
+			if (_mm_movemask_ps(_mm_and_ps(notOccluded, _mm_castsi128_ps(inRange))))
+				return true;
+		}
+#else
+		for (int x = beginX; x <= endX; x++)
+		{
+			if (row[x] >= minZ)
+				return true;
+		}
+#endif
+	}
+	return false;
+}
+
+void OcclusionCuller::FilterVisible(const Aabb* bounds, std::vector<unsigned int>& objects, const float* viewProjection) const
+{
+	objects.erase(std::remove_if(objects.begin(), objects.end(), [&](unsigned int object) {
+		return !IsVisible(bounds[object], viewProjection);
+	}), objects.end());
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+struct Aabb;
+
+// Software occlusion culling against a small CPU depth buffer
+// Occluders come from the same vertex/index source data that is handed to VertexBuffer and IndexBuffer, they are
+// transformed on the calling thread and rasterized in horizontal bands on the WorkerPool, 4 pixels per step with SSE
+// Depth is window space [0, 1] with smaller values closer, matching the default glDepthRange
+class OcclusionCuller
+{
+public:
+	// threadCount is the number of bands the rows are split into, 0 picks one per WorkerPool thread
+	OcclusionCuller(unsigned int width = 256, unsigned int height = 128, unsigned int threadCount = 0);
+
+	// Reset the depth buffer to the far plane and drop last frame's occluders
+	void BeginFrame();
+
+	// positionOffset is the byte offset of the float3 position inside each vertex, modelViewProjection is column major
+	// Triangles that cross the near plane are dropped, which can only make the result more conservative
+	void AddOccluder(const void* vertices, unsigned int vertexSize, unsigned int positionOffset, unsigned int vertexCount,
+		const unsigned int* indices, unsigned int indexCount, const float* modelViewProjection);
+
+	void Rasterize();
+
+	// False only when the box is off screen or every pixel it covers already has something closer in front of it
+	bool IsVisible(const Aabb& bounds, const float* viewProjection) const;
+	// Remove the occluded entries from a list of object indices, for example the output of a frustum query
+	void FilterVisible(const Aabb* bounds, std::vector<unsigned int>& objects, const float* viewProjection) const;
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetTriangleCount() const { return (unsigned int)m_Triangles.size(); }
+	inline const float* GetDepth() const { return m_Depth.data(); }
+private:
+	struct ScreenTriangle
+	{
+		float x[3], y[3], z[3];
+	};
+
+	void RasterizeBand(unsigned int rowBegin, unsigned int rowEnd);
+	void RasterizeTriangle(const ScreenTriangle& triangle, unsigned int rowBegin, unsigned int rowEnd);
+
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_ThreadCount; // Bands, each one a WorkerPool task
+	std::vector<float> m_Depth;
+	std::vector<ScreenTriangle> m_Triangles;
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "RadixSort.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Below this many items per chunk waking the workers costs more than it saves
+static const size_t MinItemsPerThread = 64 * 1024;
+
+static void CountDigits(const SortItem* items, size_t begin, size_t end, unsigned int shift, size_t* histogram)
+{
+	memset(histogram, 0, 256 * sizeof(size_t));
+	for (size_t i = begin; i < end; i++)
+		histogram[(items[i].key >> shift) & 0xFF]++;
+}
+
+static void ScatterDigits(const SortItem* source, SortItem* destination, size_t begin, size_t end, unsigned int shift, size_t* offsets)
+{
+	for (size_t i = begin; i < end; i++)
+		destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+}
+
+void RadixSort(SortItem* items, SortItem* scratch, size_t count, unsigned int threadCount)
+{
+	if (count < 2)
+		return;
+
+	if (threadCount == 0)
+		threadCount = WorkerPool::Get().GetThreadCount();
+	threadCount = (unsigned int)std::min<size_t>(threadCount, std::max<size_t>(1, count / MinItemsPerThread));
+
+	// Each thread owns one contiguous chunk, which keeps the sort stable
+	std::vector<size_t> chunkStarts(threadCount + 1);
+	for (unsigned int t = 0; t <= threadCount; t++)
+		chunkStarts[t] = count * t / threadCount;
+
+	// One histogram per thread, the scatter pass turns it into write offsets
+	std::vector<size_t> histograms(threadCount * 256);
+
+	SortItem* source = items;
+	SortItem* destination = scratch;
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		if (threadCount == 1)
+		{
+			CountDigits(source, 0, count, shift, histograms.data());
+		}
+		else
+		{
+			WorkerPool::Get().ParallelFor(threadCount, [&](unsigned int t) {
+				CountDigits(source, chunkStarts[t], chunkStarts[t + 1], shift, &histograms[t * 256]);
+			});
+		}
+
+		// Skip the pass when every key has the same digit here
+		bool trivial = false;
+		for (unsigned int digit = 0; digit < 256 && !trivial; digit++)
+		{
+			size_t total = 0;
+			for (unsigned int t = 0; t < threadCount; t++)
+				total += histograms[t * 256 + digit];
+			trivial = total == count;
+		}
+		if (trivial)
+			continue;
+
+		// Digit major, thread minor prefix sum gives every thread its own write range per digit
+		size_t offset = 0;
+		for (unsigned int digit = 0; digit < 256; digit++)
+		{
+			for (unsigned int t = 0; t < threadCount; t++)
+			{
+				size_t digitCount = histograms[t * 256 + digit];
+				histograms[t * 256 + digit] = offset;
+				offset += digitCount;
+			}
+		}
+
+		if (threadCount == 1)
+		{
+			ScatterDigits(source, destination, 0, count, shift, histograms.data());
+		}
+		else
+		{
+			WorkerPool::Get().ParallelFor(threadCount, [&](unsigned int t) {
+				ScatterDigits(source, destination, chunkStarts[t], chunkStarts[t + 1], shift, &histograms[t * 256]);
+			});
+		}
+
+		std::swap(source, destination);
+	}
+
+	// An odd number of real passes leaves the result in scratch
+	if (source != items)
+		memcpy(items, source, count * sizeof(SortItem));
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// A sort key and the index of whatever it sorts
+struct SortItem
+{
+	unsigned long long key;
+	unsigned int index;
+};
+
+// Stable LSD radix sort on the 64 bit key, 8 bits per pass
+// Passes where every key has the same byte are skipped, so short keys only pay for the bytes they use
+// Large inputs are split into threadCount chunks run on the WorkerPool (0 picks one per pool thread)
+// scratch must hold count items, the result ends up back in items
+void RadixSort(SortItem* items, SortItem* scratch, size_t count, unsigned int threadCount = 0);
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "RenderGraph.h"
+#include "Renderer.h"
+#include "Texture.h"
+
+#include <algorithm>
+
+RenderGraphBuilder::RenderGraphBuilder(RenderGraph& graph, unsigned int pass)
+	: m_Graph(graph), m_Pass(pass)
+{
+}
+
+RenderGraphResource RenderGraphBuilder::CreateTexture(const std::string& name, const TransientTextureDescription& description)
+{
+	return m_Graph.CreateTexture(name, description);
+}
+
+RenderGraphResource RenderGraphBuilder::CreateBuffer(const std::string& name, unsigned int size)
+{
+	return m_Graph.CreateBuffer(name, size);
+}
+
+RenderGraphResource RenderGraphBuilder::Read(RenderGraphResource resource)
+{
+	m_Graph.m_Passes[m_Pass].reads.push_back(resource);
+	m_Graph.m_Resources[resource].accesses.push_back({ m_Pass, false });
+	return resource;
+}
+
+RenderGraphResource RenderGraphBuilder::Write(RenderGraphResource resource)
+{
+	m_Graph.m_Passes[m_Pass].writes.push_back(resource);
+	m_Graph.m_Resources[resource].accesses.push_back({ m_Pass, true });
+	return resource;
+}
+
+void RenderGraphBuilder::SetSideEffect()
+{
+	m_Graph.m_Passes[m_Pass].sideEffect = true;
+}
+
+RenderGraph::RenderGraph(RenderTargetPool& pool)
+	: m_Pool(pool), m_Statistics(), m_Compiled(false)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	Reset();
+}
+
+RenderGraphResource RenderGraph::AddResource(const std::string& name, bool isTexture, bool imported,
+	const TransientTextureDescription& description, unsigned int bufferSize, unsigned int physicalId)
+{
+	Resource resource;
+	resource.name = name;
+	resource.isTexture = isTexture;
+	resource.imported = imported;
+	resource.description = description;
+	resource.bufferSize = bufferSize;
+	resource.physicalId = physicalId;
+	resource.firstUse = 0xFFFFFFFF;
+	resource.lastUse = 0;
+	m_Resources.push_back(resource);
+	return (RenderGraphResource)m_Resources.size() - 1;
+}
+
+unsigned int RenderGraph::AddPass(const std::string& name, const SetupFunction& setup, const ExecuteFunction& execute)
+{
+	ASSERT(!m_Compiled);
+	Pass pass;
+	pass.name = name;
+	pass.execute = execute;
+	pass.sideEffect = false;
+	pass.alive = false;
+	pass.starved = false;
+	pass.framebuffer = 0;
+	pass.width = 0;
+	pass.height = 0;
+	m_Passes.push_back(pass);
+
+	unsigned int index = (unsigned int)m_Passes.size() - 1;
+	RenderGraphBuilder builder(*this, index);
+	setup(builder);
+	return index;
+}
+
+RenderGraphResource RenderGraph::CreateTexture(const std::string& name, const TransientTextureDescription& description)
+{
+	return AddResource(name, true, false, description, 0, 0);
+}
+
+RenderGraphResource RenderGraph::CreateBuffer(const std::string& name, unsigned int size)
+{
+	return AddResource(name, false, false, TransientTextureDescription{ 0, 0, 0 }, size, 0);
+}
+
+RenderGraphResource RenderGraph::ImportTexture(const std::string& name, unsigned int textureId, const TransientTextureDescription& description)
+{
+	return AddResource(name, true, true, description, 0, textureId);
+}
+
+void RenderGraph::BuildDependencies()
+{
+	for (Pass& pass : m_Passes)
+	{
+		pass.producers.clear();
+		pass.predecessors.clear();
+	}
+
+	// Walk each resource's accesses in declaration order, every write starts a new version of it
+	for (const Resource& resource : m_Resources)
+	{
+		unsigned int firstWriter = 0xFFFFFFFF;
+		for (const Access& access : resource.accesses)
+		{
+			if (access.write)
+			{
+				firstWriter = access.pass;
+				break;
+			}
+		}
+
+		unsigned int lastWriter = 0xFFFFFFFF;
+		std::vector<unsigned int> readers; // Of the current version
+		for (const Access& access : resource.accesses)
+		{
+			Pass& pass = m_Passes[access.pass];
+			if (!access.write)
+			{
+				// Transient contents are undefined before their first write, so early reads wait for it, while
+				// imported ones read what was there before the graph ran
+				unsigned int producer = lastWriter != 0xFFFFFFFF ? lastWriter : (resource.imported ? 0xFFFFFFFF : firstWriter);
+				if (producer != 0xFFFFFFFF && producer != access.pass)
+				{
+					pass.producers.push_back(producer);
+					pass.predecessors.push_back(producer);
+				}
+				readers.push_back(access.pass);
+				continue;
+			}
+
+			// The first write of a transient resource produces what the early readers read, they stay with it
+			if (lastWriter == 0xFFFFFFFF && !resource.imported)
+			{
+				lastWriter = access.pass;
+				continue;
+			}
+
+			// Write after read and write after write
+			for (unsigned int reader : readers)
+			{
+				if (reader != access.pass)
+					pass.predecessors.push_back(reader);
+			}
+			if (lastWriter != 0xFFFFFFFF && lastWriter != access.pass)
+				pass.predecessors.push_back(lastWriter);
+			readers.clear();
+			lastWriter = access.pass;
+		}
+	}
+}
+
+void RenderGraph::CullPasses()
+{
+	// Flood backwards from the passes that matter on their own through the writers of what they read
+	std::vector<unsigned int> stack;
+	for (unsigned int i = 0; i < m_Passes.size(); i++)
+	{
+		Pass& pass = m_Passes[i];
+		pass.alive = pass.sideEffect;
+		for (RenderGraphResource resource : pass.writes)
+			pass.alive = pass.alive || m_Resources[resource].imported;
+		if (pass.alive)
+			stack.push_back(i);
+	}
+
+	while (!stack.empty())
+	{
+		const Pass& pass = m_Passes[stack.back()];
+		stack.pop_back();
+		for (unsigned int producer : pass.producers)
+		{
+			if (m_Passes[producer].alive)
+				continue;
+			m_Passes[producer].alive = true;
+			stack.push_back(producer);
+		}
+	}
+}
+
+void RenderGraph::SortPasses()
+{
+	// Kahn's algorithm over the dependencies between alive passes, ties go to the pass declared first so the order is stable
+	std::vector<unsigned int> incoming(m_Passes.size(), 0);
+	std::vector<std::vector<unsigned int>> outgoing(m_Passes.size());
+	for (unsigned int i = 0; i < m_Passes.size(); i++)
+	{
+		if (!m_Passes[i].alive)
+			continue;
+		for (unsigned int predecessor : m_Passes[i].predecessors)
+		{
+			if (!m_Passes[predecessor].alive)
+				continue;
+			outgoing[predecessor].push_back(i);
+			incoming[i]++;
+		}
+	}
+
+	std::vector<unsigned int> ready;
+	for (unsigned int i = 0; i < m_Passes.size(); i++)
+	{
+		if (m_Passes[i].alive && incoming[i] == 0)
+			ready.push_back(i);
+	}
+
+	m_Order.clear();
+	while (!ready.empty())
+	{
+		auto next = std::min_element(ready.begin(), ready.end());
+		unsigned int pass = *next;
+		ready.erase(next);
+		m_Order.push_back(pass);
+
+		for (unsigned int successor : outgoing[pass])
+		{
+			if (--incoming[successor] == 0)
+				ready.push_back(successor);
+		}
+	}
+
+	unsigned int aliveCount = 0;
+	for (const Pass& pass : m_Passes)
+		aliveCount += pass.alive ? 1 : 0;
+	// Anything left over sits on a cycle, which means two passes each wait for the other's output
+	ASSERT(m_Order.size() == aliveCount);
+}
+
+void RenderGraph::AllocateResources()
+{
+	for (Resource& resource : m_Resources)
+	{
+		resource.firstUse = 0xFFFFFFFF;
+		resource.lastUse = 0;
+	}
+
+	// Lifetime of every resource as a range of positions in the execution order
+	for (unsigned int position = 0; position < m_Order.size(); position++)
+	{
+		const Pass& pass = m_Passes[m_Order[position]];
+		for (const std::vector<RenderGraphResource>* list : { &pass.reads, &pass.writes })
+		{
+			for (RenderGraphResource resource : *list)
+			{
+				m_Resources[resource].firstUse = std::min(m_Resources[resource].firstUse, position);
+				m_Resources[resource].lastUse = std::max(m_Resources[resource].lastUse, position);
+			}
+		}
+	}
+
+	// Walk the order acquiring resources at their first use and releasing them after their last, a released
+	// texture goes straight back to the pool and is picked up by the next resource with the same description
+	std::vector<unsigned int> physicalTextures;
+	for (unsigned int position = 0; position < m_Order.size(); position++)
+	{
+		for (Resource& resource : m_Resources)
+		{
+			if (resource.imported || resource.firstUse != position)
+				continue;
+
+			if (resource.isTexture)
+			{
+				resource.physicalId = m_Pool.AcquireTexture(resource.description);
+				if (!resource.physicalId)
+					continue;
+				unsigned long long bytes = (unsigned long long)resource.description.width * resource.description.height * Texture::GetBytesPerPixel(resource.description.internalFormat);
+				m_Statistics.transientTextureCount++;
+				m_Statistics.transientTextureBytes += bytes;
+				if (std::find(physicalTextures.begin(), physicalTextures.end(), resource.physicalId) == physicalTextures.end())
+				{
+					physicalTextures.push_back(resource.physicalId);
+					m_Statistics.physicalTextureBytes += bytes;
+				}
+			}
+			else
+			{
+				resource.physicalId = m_Pool.AcquireBuffer(resource.bufferSize);
+			}
+		}
+
+		for (Resource& resource : m_Resources)
+		{
+			if (resource.imported || !resource.physicalId || resource.lastUse != position)
+				continue;
+			if (resource.isTexture)
+				m_Pool.ReleaseTexture(resource.physicalId);
+			else
+				m_Pool.ReleaseBuffer(resource.physicalId);
+		}
+	}
+	m_Statistics.physicalTextureCount = (unsigned int)physicalTextures.size();
+
+	// Framebuffers come last, now that every written texture has its GL name
+	for (unsigned int passIndex : m_Order)
+	{
+		Pass& pass = m_Passes[passIndex];
+
+		// The memory budget refused something this pass touches, it is skipped rather than run against nothing
+		for (const std::vector<RenderGraphResource>* list : { &pass.reads, &pass.writes })
+		{
+			for (RenderGraphResource resource : *list)
+				pass.starved |= m_Resources[resource].physicalId == 0;
+		}
+		if (pass.starved)
+		{
+			m_Statistics.starvedPassCount++;
+			continue;
+		}
+
+		std::vector<unsigned int> colors;
+		unsigned int depth = 0, depthFormat = 0;
+		for (RenderGraphResource written : pass.writes)
+		{
+			const Resource& resource = m_Resources[written];
+			if (!resource.isTexture)
+				continue;
+			if (RenderTargetPool::IsDepthFormat(resource.description.internalFormat))
+			{
+				depth = resource.physicalId;
+				depthFormat = resource.description.internalFormat;
+			}
+			else
+				colors.push_back(resource.physicalId);
+			pass.width = resource.description.width;
+			pass.height = resource.description.height;
+		}
+		if (!colors.empty() || depth)
+			pass.framebuffer = m_Pool.GetFramebuffer(colors.data(), (unsigned int)colors.size(), depth, depthFormat);
+	}
+}
+
+void RenderGraph::Compile()
+{
+	ASSERT(!m_Compiled);
+	m_Statistics = Statistics();
+	m_Statistics.passCount = (unsigned int)m_Passes.size();
+
+	BuildDependencies();
+	CullPasses();
+	SortPasses();
+	m_Statistics.culledPassCount = m_Statistics.passCount - (unsigned int)m_Order.size();
+	AllocateResources();
+	m_Compiled = true;
+}
+
+void RenderGraph::Execute()
+{
+	ASSERT(m_Compiled);
+
+	// Passes without render targets draw into the default framebuffer with the viewport the caller set up
+	int viewport[4];
+	GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+
+	for (unsigned int passIndex : m_Order)
+	{
+		const Pass& pass = m_Passes[passIndex];
+		if (pass.starved)
+			continue;
+		if (pass.framebuffer)
+		{
+			GLCall(glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer));
+			GLCall(glViewport(0, 0, pass.width, pass.height));
+		}
+		else
+		{
+			GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+			GLCall(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+		}
+		pass.execute(*this);
+	}
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCall(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+}
+
+void RenderGraph::Reset()
+{
+	m_Resources.clear();
+	m_Passes.clear();
+	m_Order.clear();
+	m_Compiled = false;
+}
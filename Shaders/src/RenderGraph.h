@@ -0,0 +1,132 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RenderTargetPool.h"
+
+typedef unsigned int RenderGraphResource;
+
+class RenderGraph;
+
+// Handed to a pass setup function to declare what the pass touches
+class RenderGraphBuilder
+{
+	friend class RenderGraph;
+private:
+	RenderGraph& m_Graph;
+	unsigned int m_Pass;
+
+	RenderGraphBuilder(RenderGraph& graph, unsigned int pass);
+public:
+	RenderGraphResource CreateTexture(const std::string& name, const TransientTextureDescription& description);
+	RenderGraphResource CreateBuffer(const std::string& name, unsigned int size);
+
+	// Reads see the latest write declared before them, a transient resource read before any write sees its first write
+	RenderGraphResource Read(RenderGraphResource resource);
+	// Written textures become the pass framebuffer, color targets in the order written and a depth format as depth
+	// A write runs after every earlier declared read and write of the resource, so overwrites never race their readers
+	RenderGraphResource Write(RenderGraphResource resource);
+	// Keep the pass even if nothing reads what it writes, for passes drawing to the default framebuffer
+	void SetSideEffect();
+};
+
+// Frame graph: passes declare their transient textures and buffers up front, Compile culls every pass whose results
+// are never used, orders the rest by their dependencies and maps transient resources whose lifetimes do not overlap
+// onto the same pooled texture or buffer, then Execute runs the passes with their framebuffers bound
+// Build, compile and execute it once per frame, the pool keeps the GL objects alive in between
+class RenderGraph
+{
+	friend class RenderGraphBuilder;
+public:
+	typedef std::function<void(RenderGraphBuilder& builder)> SetupFunction;
+	typedef std::function<void(const RenderGraph& graph)> ExecuteFunction;
+
+	struct Statistics
+	{
+		unsigned int passCount;
+		unsigned int culledPassCount;
+		unsigned int starvedPassCount; // Skipped because the memory budget refused one of their resources
+		unsigned int transientTextureCount; // Virtual textures declared by alive passes
+		unsigned int physicalTextureCount; // Pooled textures they were aliased onto
+		unsigned long long transientTextureBytes;
+		unsigned long long physicalTextureBytes;
+	};
+private:
+	struct Access
+	{
+		unsigned int pass;
+		bool write;
+	};
+
+	struct Resource
+	{
+		std::string name;
+		bool isTexture;
+		bool imported; // Owned outside the graph, never aliased and writing it counts as a side effect
+		TransientTextureDescription description;
+		unsigned int bufferSize;
+		unsigned int physicalId; // GL name, valid between Compile and the end of Execute
+		std::vector<Access> accesses; // In declaration order
+		unsigned int firstUse;
+		unsigned int lastUse;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		ExecuteFunction execute;
+		std::vector<RenderGraphResource> reads;
+		std::vector<RenderGraphResource> writes;
+		std::vector<unsigned int> producers; // Passes writing what this pass reads
+		std::vector<unsigned int> predecessors; // Every pass that has to run first, producers included
+		bool sideEffect;
+		bool alive;
+		bool starved; // A resource it touches could not be allocated
+		unsigned int framebuffer;
+		unsigned int width, height; // Viewport from the written textures
+	};
+
+	RenderTargetPool& m_Pool;
+	std::vector<Resource> m_Resources;
+	std::vector<Pass> m_Passes;
+	std::vector<unsigned int> m_Order; // Alive passes in execution order
+	Statistics m_Statistics;
+	bool m_Compiled;
+
+	RenderGraphResource AddResource(const std::string& name, bool isTexture, bool imported, const TransientTextureDescription& description, unsigned int bufferSize, unsigned int physicalId);
+	void BuildDependencies();
+	void CullPasses();
+	void SortPasses();
+	void AllocateResources();
+public:
+	RenderGraph(RenderTargetPool& pool);
+	~RenderGraph();
+
+	unsigned int AddPass(const std::string& name, const SetupFunction& setup, const ExecuteFunction& execute);
+
+	// Resources can be declared ahead of the passes using them, so a pass can read a transient resource whose writer is added later
+	RenderGraphResource CreateTexture(const std::string& name, const TransientTextureDescription& description);
+	RenderGraphResource CreateBuffer(const std::string& name, unsigned int size);
+
+	// Bring in a texture the graph does not own, such as last frame's history or a streamed Texture2D
+	// Framebuffers for it stay cached in the pool, call RenderTargetPool::DeleteFramebuffersUsing before deleting it
+	RenderGraphResource ImportTexture(const std::string& name, unsigned int textureId, const TransientTextureDescription& description);
+
+	void Compile();
+	// Runs every alive pass in order, transient resources were already handed back to the pool by Compile
+	// Passes whose resources did not fit in the memory budget are skipped
+	void Execute();
+	// Forget this frame's passes and resources, the pooled GL objects stay
+	void Reset();
+
+	// During Execute: the GL name behind a resource
+	inline unsigned int GetTexture(RenderGraphResource resource) const { return m_Resources[resource].physicalId; }
+	inline unsigned int GetBuffer(RenderGraphResource resource) const { return m_Resources[resource].physicalId; }
+	inline const TransientTextureDescription& GetDescription(RenderGraphResource resource) const { return m_Resources[resource].description; }
+
+	inline bool IsPassAlive(unsigned int pass) const { return m_Passes[pass].alive; }
+	inline const std::vector<unsigned int>& GetExecutionOrder() const { return m_Order; }
+	inline const Statistics& GetStatistics() const { return m_Statistics; }
+};
\ No newline at end of file
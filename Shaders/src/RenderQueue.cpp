@@ -0,0 +1,121 @@
+#include "RenderQueue.h"
+#include "Renderer.h"
+#include "IndexBuffer.h"
+
+// Ids have to fit the 12 bit key fields
+static const unsigned int MaxCompactId = 0xFFF;
+
+RenderQueue::RenderQueue()
+	: m_StateChanges(0)
+{
+	for (CompactIds* table : { &m_ProgramIds, &m_MaterialIds, &m_VertexArrayIds })
+		ResetIds(*table);
+}
+
+unsigned int RenderQueue::GetCompactId(CompactIds& table, unsigned int name)
+{
+	if (name == table.lastName)
+		return table.lastId;
+
+	auto it = table.ids.find(name);
+	unsigned int id;
+	if (it != table.ids.end())
+		id = it->second;
+	else if (table.ids.size() < MaxCompactId)
+	{
+		id = (unsigned int)table.ids.size();
+		table.ids.emplace(name, id);
+	}
+	else
+		id = MaxCompactId; // Out of ids, everything new shares the last bucket
+
+	table.lastName = name;
+	table.lastId = id;
+	return id;
+}
+
+void RenderQueue::ResetIds(CompactIds& table)
+{
+	table.ids.clear();
+	// No GL object is ever named 0xFFFFFFFF, a material using it just lands in the shared bucket
+	table.lastName = 0xFFFFFFFF;
+	table.lastId = MaxCompactId;
+}
+
+unsigned long long RenderQueue::MakeSortKey(unsigned int pass, unsigned int layer, unsigned int program,
+	unsigned int material, unsigned int vertexArray, float depth, bool backToFront)
+{
+	// Quantize depth to 16 bits, clamping anything outside [0, 1]
+	if (depth < 0.0f) depth = 0.0f;
+	if (depth > 1.0f) depth = 1.0f;
+	unsigned long long depthBits = (unsigned long long)(depth * 65535.0f);
+	if (backToFront)
+		depthBits = 65535 - depthBits;
+
+	return ((unsigned long long)(pass & 0xF) << 60)
+		| ((unsigned long long)(layer & 0xFF) << 52)
+		| ((unsigned long long)GetCompactId(m_ProgramIds, program) << 40)
+		| ((unsigned long long)GetCompactId(m_MaterialIds, material) << 28)
+		| ((unsigned long long)GetCompactId(m_VertexArrayIds, vertexArray) << 16)
+		| depthBits;
+}
+
+void RenderQueue::Sort()
+{
+	m_Scratch.resize(m_Items.size());
+	RadixSort(m_Items.data(), m_Scratch.data(), m_Items.size());
+}
+
+void RenderQueue::Execute()
+{
+	Sort();
+
+	// Invalid names so the first draw binds everything
+	unsigned int program = 0xFFFFFFFF;
+	unsigned int material = 0xFFFFFFFF;
+	unsigned int vertexArray = 0xFFFFFFFF;
+	m_StateChanges = 0;
+
+	for (const SortItem& item : m_Items)
+	{
+		const DrawCommand& command = m_Commands[item.index];
+		if (command.program != program)
+		{
+			program = command.program;
+			GLCall(glUseProgram(program));
+			// Uniforms set by the material binder belong to the program, so rebind it as well
+			material = 0xFFFFFFFF;
+			m_StateChanges++;
+		}
+		if (command.material != material)
+		{
+			material = command.material;
+			if (m_MaterialBinder)
+				m_MaterialBinder(material);
+			m_StateChanges++;
+		}
+		if (command.vertexArray != vertexArray)
+		{
+			vertexArray = command.vertexArray;
+			GLCall(glBindVertexArray(vertexArray));
+			m_StateChanges++;
+		}
+
+		GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.indexCount, command.indexType,
+			(void*)((size_t)command.firstIndex * IndexBuffer::GetSizeOfType(command.indexType)), command.instanceCount, command.baseVertex));
+	}
+
+	Clear();
+}
+
+void RenderQueue::Clear()
+{
+	m_Commands.clear();
+	m_Items.clear();
+	// A table that ran out of ids starts over, names then get ids again in the order next frame submits them
+	for (CompactIds* table : { &m_ProgramIds, &m_MaterialIds, &m_VertexArrayIds })
+	{
+		if (table->ids.size() >= MaxCompactId)
+			ResetIds(*table);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "RadixSort.h"
+
+// Everything needed to issue one draw, kept small so a million of them stay cheap to move around
+struct DrawCommand
+{
+	unsigned int program; // GL program name
+	unsigned int vertexArray; // GL vertex array name, its index buffer is part of it
+	unsigned int material; // Passed to the material binder when it changes
+	unsigned int indexType; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	unsigned int indexCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int instanceCount;
+};
+
+// Collects draws during the frame, sorts them by key and executes them with as few state changes as possible
+// Key layout from the top bit down: pass 4 | layer 8 | program 12 | material 12 | vertex array 12 | depth 16
+// so all draws of a pass run together, then everything sharing a program, then a material, then a vertex array
+// Programs, materials and vertex arrays go into the key as small ids the queue hands out, never as raw GL names
+class RenderQueue
+{
+private:
+	// Dense ids in the order names are first seen, they stay the same across frames so the draw order does too
+	struct CompactIds
+	{
+		std::unordered_map<unsigned int, unsigned int> ids;
+		unsigned int lastName; // Consecutive submissions mostly share state, this skips the hash lookup for them
+		unsigned int lastId;
+	};
+
+	std::vector<DrawCommand> m_Commands;
+	std::vector<SortItem> m_Items;
+	std::vector<SortItem> m_Scratch;
+	std::function<void(unsigned int material)> m_MaterialBinder;
+	unsigned int m_StateChanges; // Program, material and vertex array changes in the last Execute
+	CompactIds m_ProgramIds;
+	CompactIds m_MaterialIds;
+	CompactIds m_VertexArrayIds;
+
+	static unsigned int GetCompactId(CompactIds& table, unsigned int name);
+	static void ResetIds(CompactIds& table);
+public:
+	RenderQueue();
+
+	// Depth is the view space distance in [0, 1], flip it for back to front passes such as transparency
+	// Past 4095 distinct names of one kind the rest share a sort bucket until Clear starts the ids over, the draws
+	// stay correct and only group less well
+	unsigned long long MakeSortKey(unsigned int pass, unsigned int layer, unsigned int program,
+		unsigned int material, unsigned int vertexArray, float depth, bool backToFront = false);
+
+	inline void Reserve(unsigned int count) { m_Commands.reserve(count); m_Items.reserve(count); }
+	inline void Submit(unsigned long long key, const DrawCommand& command)
+	{
+		m_Items.push_back({ key, (unsigned int)m_Commands.size() });
+		m_Commands.push_back(command);
+	}
+
+	// Called whenever the material changes between two draws, after the program is bound
+	inline void SetMaterialBinder(const std::function<void(unsigned int material)>& binder) { m_MaterialBinder = binder; }
+
+	// Sort, draw and clear everything submitted this frame
+	void Execute();
+	// Only sort, for callers that walk the commands themselves
+	void Sort();
+	void Clear();
+
+	inline unsigned int GetCommandCount() const { return (unsigned int)m_Commands.size(); }
+	inline const DrawCommand& GetSortedCommand(unsigned int i) const { return m_Commands[m_Items[i].index]; }
+	inline unsigned int GetStateChanges() const { return m_StateChanges; }
+};
\ No newline at end of file
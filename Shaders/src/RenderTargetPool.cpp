@@ -0,0 +1,247 @@
+#include "RenderTargetPool.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "GpuMemory.h"
+
+#include <algorithm>
+
+RenderTargetPool::RenderTargetPool()
+	: m_Frame(0)
+{
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+	Clear();
+}
+
+bool RenderTargetPool::IsDepthFormat(unsigned int internalFormat)
+{
+	return internalFormat == GL_DEPTH_COMPONENT24 || internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH_COMPONENT32F;
+}
+
+unsigned int RenderTargetPool::AcquireTexture(const TransientTextureDescription& description)
+{
+	for (PooledTexture& pooled : m_Textures)
+	{
+		if (!pooled.inUse && pooled.description == description)
+		{
+			pooled.inUse = true;
+			pooled.lastUsedFrame = m_Frame;
+			return pooled.textureId;
+		}
+	}
+
+	// Render targets are never mipmapped and never read from the CPU, one level of immutable storage is all they need
+	PooledTexture pooled;
+	pooled.description = description;
+	pooled.size = (unsigned long long)description.width * description.height * Texture::GetBytesPerPixel(description.internalFormat);
+	pooled.lastUsedFrame = m_Frame;
+	pooled.inUse = true;
+
+	// Over budget, drop every free pooled resource before giving up, they would only be deleted a few frames later
+	if (!GpuMemoryTracker::Get().TryAllocate(GpuMemoryCategory::RenderTarget, pooled.size))
+	{
+		DeleteUnused(0);
+		if (!GpuMemoryTracker::Get().TryAllocate(GpuMemoryCategory::RenderTarget, pooled.size))
+			return 0;
+	}
+
+	GLCall(glGenTextures(1, &pooled.textureId));
+	GLCall(glBindTexture(GL_TEXTURE_2D, pooled.textureId));
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+	{
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, 1, description.internalFormat, description.width, description.height));
+	}
+	else
+	{
+		GLenum format = IsDepthFormat(description.internalFormat)
+			? (description.internalFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL : GL_DEPTH_COMPONENT) : GL_RGBA;
+		GLenum type = description.internalFormat == GL_DEPTH24_STENCIL8 ? GL_UNSIGNED_INT_24_8 : GL_UNSIGNED_BYTE;
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, description.internalFormat, description.width, description.height, 0, format, type, nullptr));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+	}
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	m_Textures.push_back(pooled);
+	return pooled.textureId;
+}
+
+void RenderTargetPool::ReleaseTexture(unsigned int textureId)
+{
+	for (PooledTexture& pooled : m_Textures)
+	{
+		if (pooled.textureId == textureId)
+		{
+			pooled.inUse = false;
+			return;
+		}
+	}
+	ASSERT(false);
+}
+
+unsigned int RenderTargetPool::AcquireBuffer(unsigned int size)
+{
+	// Smallest free buffer that is big enough
+	PooledBuffer* best = nullptr;
+	for (PooledBuffer& pooled : m_Buffers)
+	{
+		if (!pooled.inUse && pooled.size >= size && (!best || pooled.size < best->size))
+			best = &pooled;
+	}
+	if (best)
+	{
+		best->inUse = true;
+		best->lastUsedFrame = m_Frame;
+		return best->bufferId;
+	}
+
+	if (!GpuMemoryTracker::Get().TryAllocate(GpuMemoryCategory::Other, size))
+	{
+		DeleteUnused(0);
+		if (!GpuMemoryTracker::Get().TryAllocate(GpuMemoryCategory::Other, size))
+			return 0;
+	}
+
+	PooledBuffer pooled = { 0, size, m_Frame, true };
+	GLCall(glGenBuffers(1, &pooled.bufferId));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, pooled.bufferId));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_COPY));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+
+	m_Buffers.push_back(pooled);
+	return pooled.bufferId;
+}
+
+void RenderTargetPool::ReleaseBuffer(unsigned int bufferId)
+{
+	for (PooledBuffer& pooled : m_Buffers)
+	{
+		if (pooled.bufferId == bufferId)
+		{
+			pooled.inUse = false;
+			return;
+		}
+	}
+	ASSERT(false);
+}
+
+unsigned int RenderTargetPool::GetFramebuffer(const unsigned int* colorTextures, unsigned int colorCount, unsigned int depthTexture, unsigned int depthFormat)
+{
+	std::vector<unsigned int> key(colorTextures, colorTextures + colorCount);
+	key.push_back(depthTexture);
+
+	auto it = m_Framebuffers.find(key);
+	if (it != m_Framebuffers.end())
+		return it->second;
+
+	unsigned int framebuffer;
+	GLCall(glGenFramebuffers(1, &framebuffer));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+
+	std::vector<GLenum> drawBuffers(colorCount);
+	for (unsigned int i = 0; i < colorCount; i++)
+	{
+		GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colorTextures[i], 0));
+		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+	}
+	if (colorCount)
+	{
+		GLCall(glDrawBuffers(colorCount, drawBuffers.data()));
+	}
+	else
+	{
+		GLCall(glDrawBuffer(GL_NONE));
+	}
+
+	if (depthTexture)
+	{
+		GLenum attachment = depthFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, depthTexture, 0));
+	}
+
+	GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	ASSERT(status == GL_FRAMEBUFFER_COMPLETE);
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+	m_Framebuffers.emplace(key, framebuffer);
+	return framebuffer;
+}
+
+void RenderTargetPool::DeleteFramebuffersUsing(unsigned int textureId)
+{
+	for (auto it = m_Framebuffers.begin(); it != m_Framebuffers.end();)
+	{
+		if (std::find(it->first.begin(), it->first.end(), textureId) == it->first.end())
+		{
+			++it;
+			continue;
+		}
+		GLCall(glDeleteFramebuffers(1, &it->second));
+		it = m_Framebuffers.erase(it);
+	}
+}
+
+void RenderTargetPool::DeleteUnused(unsigned int minIdleFrames)
+{
+	// Anything still marked in use here was leaked by its pass, it stays alive rather than being deleted under it
+	for (size_t i = 0; i < m_Textures.size();)
+	{
+		PooledTexture& pooled = m_Textures[i];
+		if (pooled.inUse || m_Frame - pooled.lastUsedFrame < minIdleFrames)
+		{
+			i++;
+			continue;
+		}
+		DeleteFramebuffersUsing(pooled.textureId);
+		GLCall(glDeleteTextures(1, &pooled.textureId));
+		GpuMemoryTracker::Get().Free(GpuMemoryCategory::RenderTarget, pooled.size);
+		m_Textures.erase(m_Textures.begin() + i);
+	}
+
+	for (size_t i = 0; i < m_Buffers.size();)
+	{
+		PooledBuffer& pooled = m_Buffers[i];
+		if (pooled.inUse || m_Frame - pooled.lastUsedFrame < minIdleFrames)
+		{
+			i++;
+			continue;
+		}
+		GLCall(glDeleteBuffers(1, &pooled.bufferId));
+		GpuMemoryTracker::Get().Free(GpuMemoryCategory::Other, pooled.size);
+		m_Buffers.erase(m_Buffers.begin() + i);
+	}
+}
+
+void RenderTargetPool::EndFrame()
+{
+	DeleteUnused(MaxIdleFrames);
+	m_Frame++;
+}
+
+void RenderTargetPool::Clear()
+{
+	for (const auto& entry : m_Framebuffers)
+	{
+		GLCall(glDeleteFramebuffers(1, &entry.second));
+	}
+	m_Framebuffers.clear();
+
+	for (const PooledTexture& pooled : m_Textures)
+	{
+		GLCall(glDeleteTextures(1, &pooled.textureId));
+		GpuMemoryTracker::Get().Free(GpuMemoryCategory::RenderTarget, pooled.size);
+	}
+	m_Textures.clear();
+
+	for (const PooledBuffer& pooled : m_Buffers)
+	{
+		GLCall(glDeleteBuffers(1, &pooled.bufferId));
+		GpuMemoryTracker::Get().Free(GpuMemoryCategory::Other, pooled.size);
+	}
+	m_Buffers.clear();
+}
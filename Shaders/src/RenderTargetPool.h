@@ -0,0 +1,81 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+struct TransientTextureDescription
+{
+	unsigned int width;
+	unsigned int height;
+	unsigned int internalFormat;
+
+	bool operator==(const TransientTextureDescription& other) const
+	{
+		return width == other.width && height == other.height && internalFormat == other.internalFormat;
+	}
+};
+
+// Keeps render target textures, transient buffers and framebuffers alive across frames so passes stop allocating
+// Everything handed out is returned within the frame, anything left unused for a few frames is deleted in EndFrame
+// Textures are counted under the RenderTarget memory category and buffers under Other, when the memory budget refuses
+// a new one the pool first deletes every free resource it holds and then gives up by returning 0
+class RenderTargetPool
+{
+private:
+	struct PooledTexture
+	{
+		unsigned int textureId;
+		TransientTextureDescription description;
+		unsigned long long size;
+		unsigned int lastUsedFrame;
+		bool inUse;
+	};
+
+	struct PooledBuffer
+	{
+		unsigned int bufferId;
+		unsigned int size;
+		unsigned int lastUsedFrame;
+		bool inUse;
+	};
+
+	std::vector<PooledTexture> m_Textures;
+	std::vector<PooledBuffer> m_Buffers;
+	std::map<std::vector<unsigned int>, unsigned int> m_Framebuffers; // Attachment texture ids, depth last, to FBO
+	unsigned int m_Frame;
+
+	// Delete free textures and buffers not used for at least this many frames, with their framebuffers
+	void DeleteUnused(unsigned int minIdleFrames);
+public:
+	// Frames a free resource survives before EndFrame deletes it
+	static const unsigned int MaxIdleFrames = 3;
+
+	RenderTargetPool();
+	~RenderTargetPool();
+
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+	// Returns a free texture with exactly this description, creating one on a miss, or 0 when over the memory budget
+	unsigned int AcquireTexture(const TransientTextureDescription& description);
+	void ReleaseTexture(unsigned int textureId);
+	// Returns a free buffer of at least size bytes, or 0 when over the memory budget
+	unsigned int AcquireBuffer(unsigned int size);
+	void ReleaseBuffer(unsigned int bufferId);
+
+	// Framebuffer with these color attachments in order plus an optional depth attachment (0 for none)
+	// The attachments do not have to come from the pool, depthFormat picks between depth and depth stencil attachment
+	unsigned int GetFramebuffer(const unsigned int* colorTextures, unsigned int colorCount, unsigned int depthTexture, unsigned int depthFormat);
+	// Call before deleting a texture the pool does not own that was passed to GetFramebuffer, such as an imported one,
+	// otherwise a new texture reusing its name would get a framebuffer still attached to the old one
+	void DeleteFramebuffersUsing(unsigned int textureId);
+
+	void EndFrame();
+	void Clear();
+
+	inline unsigned int GetTextureCount() const { return (unsigned int)m_Textures.size(); }
+	inline unsigned int GetBufferCount() const { return (unsigned int)m_Buffers.size(); }
+	inline unsigned int GetFramebufferCount() const { return (unsigned int)m_Framebuffers.size(); }
+
+	static bool IsDepthFormat(unsigned int internalFormat);
+};
\ No newline at end of file
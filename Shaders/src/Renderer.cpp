@@ -1,4 +1,8 @@
 #include "Renderer.h"
+#include "Stats.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include <cstring>
 #include <iostream>
 
 // Clear all existing errors
@@ -10,10 +14,82 @@ void GLClearError()
 // Log if there is an error in OpenGL
 bool GLLogCall(const char* function, const char* file, int line)
 {
+	// Every GLCall ends up here, which makes it a cheap place to count them
+	GetRenderCounters().glCalls++;
 	while (GLenum error = glGetError())
 	{
 		std::cout << "[OpenGL Error] (" << error << "): " << function << " " << file << ":" << line << std::endl;
 		return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+bool GLHasDirectStateAccess()
+{
+	return GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access;
+}
+
+void GLBufferSubData(unsigned int buffer, long long offset, long long size, const void* data)
+{
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glNamedBufferSubData(buffer, (GLintptr)offset, (GLsizeiptr)size, data));
+		return;
+	}
+
+	// The copy target is not used by drawing, so borrowing it leaves the array and element buffers alone
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+	GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)size, data));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+}
+
+void GLBufferSubDataUnsynchronized(unsigned int buffer, long long offset, long long size, const void* data)
+{
+	const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(void* destination = glMapNamedBufferRange(buffer, (GLintptr)offset, (GLsizeiptr)size, access));
+		memcpy(destination, data, (size_t)size);
+		GLCall(glUnmapNamedBuffer(buffer));
+		return;
+	}
+
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+	GLCall(void* destination = glMapBufferRange(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)size, access));
+	memcpy(destination, data, (size_t)size);
+	GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+}
+
+void GLCopyBufferSubData(unsigned int readBuffer, unsigned int writeBuffer, long long readOffset, long long writeOffset, long long size)
+{
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glCopyNamedBufferSubData(readBuffer, writeBuffer, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)size));
+		return;
+	}
+
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, readBuffer));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, writeBuffer));
+	GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)size));
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+}
+
+void Renderer::Clear() const
+{
+	GLCall(glClear(GL_COLOR_BUFFER_BIT));
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib) const
+{
+	// The vertex array brings its index buffer with it
+	va.Bind();
+	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, unsigned int instanceCount) const
+{
+	va.Bind();
+	GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr, instanceCount));
+}
@@ -14,3 +14,26 @@
 void GLClearError();
 // Log if there is an error in OpenGL
 bool GLLogCall(const char* function, const char* file, int line);
+
+// True when GL 4.5 direct state access is available, resource classes then edit objects without binding them
+bool GLHasDirectStateAccess();
+// Write into a buffer without disturbing any binding the caller relies on
+void GLBufferSubData(unsigned int buffer, long long offset, long long size, const void* data);
+// Same write through an unsynchronized map, so the driver never stalls or copies for it. The caller has to know, usually
+// from a fence, that no draw still reads the range, and the buffer must be mappable for writing
+void GLBufferSubDataUnsynchronized(unsigned int buffer, long long offset, long long size, const void* data);
+// Copy between two buffers without disturbing any binding the caller relies on
+void GLCopyBufferSubData(unsigned int readBuffer, unsigned int writeBuffer, long long readOffset, long long writeOffset, long long size);
+
+class VertexArray;
+class IndexBuffer;
+
+class Renderer
+{
+public:
+	void Clear() const;
+	// Draw an indexed mesh with whatever shader program is bound
+	void Draw(const VertexArray& va, const IndexBuffer& ib) const;
+	// Draw instanceCount copies of the mesh in one call, per instance attributes come from buffers added with a divisor
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, unsigned int instanceCount) const;
+};
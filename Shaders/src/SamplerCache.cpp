@@ -0,0 +1,59 @@
+#include "SamplerCache.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+size_t SamplerCache::DescriptionHash::operator()(const SamplerDescription& description) const
+{
+	unsigned int anisotropyBits;
+	std::memcpy(&anisotropyBits, &description.maxAnisotropy, sizeof(anisotropyBits));
+	const unsigned int values[] = { description.minFilter, description.magFilter, description.wrapS, description.wrapT, anisotropyBits };
+
+	size_t hash = 2166136261u;
+	for (unsigned int value : values)
+		hash = (hash ^ value) * 16777619u;
+	return hash;
+}
+
+SamplerCache::~SamplerCache()
+{
+	Clear();
+}
+
+unsigned int SamplerCache::Get(const SamplerDescription& description)
+{
+	auto it = m_Samplers.find(description);
+	if (it != m_Samplers.end())
+		return it->second;
+
+	unsigned int sampler;
+	GLCall(glGenSamplers(1, &sampler));
+	GLCall(glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, description.minFilter));
+	GLCall(glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, description.magFilter));
+	GLCall(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, description.wrapS));
+	GLCall(glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, description.wrapT));
+	if (description.maxAnisotropy > 1.0f && GLEW_EXT_texture_filter_anisotropic)
+	{
+		float supported;
+		GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &supported));
+		GLCall(glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(description.maxAnisotropy, supported)));
+	}
+
+	m_Samplers.emplace(description, sampler);
+	return sampler;
+}
+
+void SamplerCache::Bind(unsigned int slot, const SamplerDescription& description)
+{
+	GLCall(glBindSampler(slot, Get(description)));
+}
+
+void SamplerCache::Clear()
+{
+	for (const auto& entry : m_Samplers)
+	{
+		GLCall(glDeleteSamplers(1, &entry.second));
+	}
+	m_Samplers.clear();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <unordered_map>
+
+// Filtering and addressing state, shared between every texture that samples the same way
+struct SamplerDescription
+{
+	unsigned int minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	unsigned int magFilter = GL_LINEAR;
+	unsigned int wrapS = GL_REPEAT;
+	unsigned int wrapT = GL_REPEAT;
+	float maxAnisotropy = 1.0f; // Clamped to what the driver supports, 1 turns it off
+
+	bool operator==(const SamplerDescription& other) const
+	{
+		return minFilter == other.minFilter && magFilter == other.magFilter && wrapS == other.wrapS
+			&& wrapT == other.wrapT && maxAnisotropy == other.maxAnisotropy;
+	}
+};
+
+// Hands out one GL sampler object per unique SamplerDescription, so sampler state lives apart from the textures
+class SamplerCache
+{
+private:
+	struct DescriptionHash
+	{
+		size_t operator()(const SamplerDescription& description) const;
+	};
+
+	std::unordered_map<SamplerDescription, unsigned int, DescriptionHash> m_Samplers;
+public:
+	~SamplerCache();
+
+	// Returns the sampler for this description, creating it on a miss
+	unsigned int Get(const SamplerDescription& description);
+	void Bind(unsigned int slot, const SamplerDescription& description);
+	void Clear();
+
+	inline unsigned int GetSize() const { return (unsigned int)m_Samplers.size(); }
+};
\ No newline at end of file
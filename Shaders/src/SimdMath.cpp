@@ -0,0 +1,289 @@
+#include "SimdMath.h"
+
+#include <cstring>
+
+Mat3 Mat3::Identity()
+{
+	Mat3 result;
+	const float identity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+	std::memcpy(result.m, identity, sizeof(identity));
+	return result;
+}
+
+Mat3 Mat3::operator*(const Mat3& o) const
+{
+	Mat3 result;
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+			result.m[column * 3 + row] = m[row] * o.m[column * 3] + m[3 + row] * o.m[column * 3 + 1] + m[6 + row] * o.m[column * 3 + 2];
+	}
+	return result;
+}
+
+Vec3 Mat3::operator*(const Vec3& v) const
+{
+	return Vec3(m[0] * v.x + m[3] * v.y + m[6] * v.z,
+		m[1] * v.x + m[4] * v.y + m[7] * v.z,
+		m[2] * v.x + m[5] * v.y + m[8] * v.z);
+}
+
+Mat3 Mat3::Transpose() const
+{
+	Mat3 result;
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+			result.m[column * 3 + row] = m[row * 3 + column];
+	}
+	return result;
+}
+
+Mat4 Mat4::Identity()
+{
+	Mat4 result;
+	std::memset(result.m, 0, sizeof(result.m));
+	result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.0f;
+	return result;
+}
+
+Mat4 Mat4::Translation(const Vec3& t)
+{
+	Mat4 result = Identity();
+	result.m[12] = t.x;
+	result.m[13] = t.y;
+	result.m[14] = t.z;
+	return result;
+}
+
+Mat4 Mat4::Scale(const Vec3& s)
+{
+	Mat4 result = Identity();
+	result.m[0] = s.x;
+	result.m[5] = s.y;
+	result.m[10] = s.z;
+	return result;
+}
+
+Mat4 Mat4::Rotation(const Quat& q)
+{
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	Mat4 result = Identity();
+	result.m[0] = 1.0f - 2.0f * (yy + zz);
+	result.m[1] = 2.0f * (xy + wz);
+	result.m[2] = 2.0f * (xz - wy);
+	result.m[4] = 2.0f * (xy - wz);
+	result.m[5] = 1.0f - 2.0f * (xx + zz);
+	result.m[6] = 2.0f * (yz + wx);
+	result.m[8] = 2.0f * (xz + wy);
+	result.m[9] = 2.0f * (yz - wx);
+	result.m[10] = 1.0f - 2.0f * (xx + yy);
+	return result;
+}
+
+Mat4 Mat4::Perspective(float fovY, float aspect, float nearPlane, float farPlane)
+{
+	float f = 1.0f / std::tan(fovY * 0.5f);
+	Mat4 result;
+	std::memset(result.m, 0, sizeof(result.m));
+	result.m[0] = f / aspect;
+	result.m[5] = f;
+	result.m[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+	result.m[11] = -1.0f;
+	result.m[14] = 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+	return result;
+}
+
+Mat4 Mat4::Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+{
+	Mat4 result = Identity();
+	result.m[0] = 2.0f / (right - left);
+	result.m[5] = 2.0f / (top - bottom);
+	result.m[10] = -2.0f / (farPlane - nearPlane);
+	result.m[12] = -(right + left) / (right - left);
+	result.m[13] = -(top + bottom) / (top - bottom);
+	result.m[14] = -(farPlane + nearPlane) / (farPlane - nearPlane);
+	return result;
+}
+
+Mat4 Mat4::LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+{
+	Vec3 forward = Normalize(target - eye);
+	Vec3 side = Normalize(Cross(forward, up));
+	Vec3 realUp = Cross(side, forward);
+
+	Mat4 result = Identity();
+	result.m[0] = side.x; result.m[4] = side.y; result.m[8] = side.z;
+	result.m[1] = realUp.x; result.m[5] = realUp.y; result.m[9] = realUp.z;
+	result.m[2] = -forward.x; result.m[6] = -forward.y; result.m[10] = -forward.z;
+	result.m[12] = -Dot(side, eye);
+	result.m[13] = -Dot(realUp, eye);
+	result.m[14] = Dot(forward, eye);
+	return result;
+}
+
+Mat4 Mat4::operator*(const Mat4& o) const
+{
+	Mat4 result;
+#ifdef SIMD_MATH_SSE2
+	// Every result column is a combination of our columns weighted by one column of o
+	__m128 c0 = _mm_load_ps(m), c1 = _mm_load_ps(m + 4), c2 = _mm_load_ps(m + 8), c3 = _mm_load_ps(m + 12);
+	for (int column = 0; column < 4; column++)
+	{
+		const float* b = o.m + column * 4;
+		__m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(b[0])), _mm_mul_ps(c1, _mm_set1_ps(b[1]))),
+			_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(b[2])), _mm_mul_ps(c3, _mm_set1_ps(b[3]))));
+		_mm_store_ps(result.m + column * 4, sum);
+	}
+#else
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+			result.m[column * 4 + row] = m[row] * o.m[column * 4] + m[4 + row] * o.m[column * 4 + 1]
+				+ m[8 + row] * o.m[column * 4 + 2] + m[12 + row] * o.m[column * 4 + 3];
+	}
+#endif
+	return result;
+}
+
+Vec4 Mat4::operator*(const Vec4& v) const
+{
+#ifdef SIMD_MATH_SSE2
+	__m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(m), _mm_set1_ps(v.x)), _mm_mul_ps(_mm_load_ps(m + 4), _mm_set1_ps(v.y))),
+		_mm_add_ps(_mm_mul_ps(_mm_load_ps(m + 8), _mm_set1_ps(v.z)), _mm_mul_ps(_mm_load_ps(m + 12), _mm_set1_ps(v.w))));
+	return Vec4(sum);
+#else
+	return Vec4(m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+		m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+		m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+		m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w);
+#endif
+}
+
+Vec3 Mat4::TransformPoint(const Vec3& p) const
+{
+	return Vec3(m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+		m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+		m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+}
+
+Vec3 Mat4::TransformDirection(const Vec3& d) const
+{
+	return Vec3(m[0] * d.x + m[4] * d.y + m[8] * d.z,
+		m[1] * d.x + m[5] * d.y + m[9] * d.z,
+		m[2] * d.x + m[6] * d.y + m[10] * d.z);
+}
+
+Mat4 Mat4::Transpose() const
+{
+	Mat4 result;
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+			result.m[column * 4 + row] = m[row * 4 + column];
+	}
+	return result;
+}
+
+Mat4 Mat4::Inverse() const
+{
+	// Cofactor expansion through the 2x2 sub determinants of the top two and bottom two rows
+	const float* a = m;
+	float s0 = a[0] * a[5] - a[4] * a[1];
+	float s1 = a[0] * a[9] - a[8] * a[1];
+	float s2 = a[0] * a[13] - a[12] * a[1];
+	float s3 = a[4] * a[9] - a[8] * a[5];
+	float s4 = a[4] * a[13] - a[12] * a[5];
+	float s5 = a[8] * a[13] - a[12] * a[9];
+	float c5 = a[10] * a[15] - a[14] * a[11];
+	float c4 = a[6] * a[15] - a[14] * a[7];
+	float c3 = a[6] * a[11] - a[10] * a[7];
+	float c2 = a[2] * a[15] - a[14] * a[3];
+	float c1 = a[2] * a[11] - a[10] * a[3];
+	float c0 = a[2] * a[7] - a[6] * a[3];
+
+	float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (determinant == 0.0f)
+		return Identity();
+	float inverse = 1.0f / determinant;
+
+	Mat4 result;
+	result.m[0] = (a[5] * c5 - a[9] * c4 + a[13] * c3) * inverse;
+	result.m[4] = (-a[4] * c5 + a[8] * c4 - a[12] * c3) * inverse;
+	result.m[8] = (a[7] * s5 - a[11] * s4 + a[15] * s3) * inverse;
+	result.m[12] = (-a[6] * s5 + a[10] * s4 - a[14] * s3) * inverse;
+	result.m[1] = (-a[1] * c5 + a[9] * c2 - a[13] * c1) * inverse;
+	result.m[5] = (a[0] * c5 - a[8] * c2 + a[12] * c1) * inverse;
+	result.m[9] = (-a[3] * s5 + a[11] * s2 - a[15] * s1) * inverse;
+	result.m[13] = (a[2] * s5 - a[10] * s2 + a[14] * s1) * inverse;
+	result.m[2] = (a[1] * c4 - a[5] * c2 + a[13] * c0) * inverse;
+	result.m[6] = (-a[0] * c4 + a[4] * c2 - a[12] * c0) * inverse;
+	result.m[10] = (a[3] * s4 - a[7] * s2 + a[15] * s0) * inverse;
+	result.m[14] = (-a[2] * s4 + a[6] * s2 - a[14] * s0) * inverse;
+	result.m[3] = (-a[1] * c3 + a[5] * c1 - a[9] * c0) * inverse;
+	result.m[7] = (a[0] * c3 - a[4] * c1 + a[8] * c0) * inverse;
+	result.m[11] = (-a[3] * s3 + a[7] * s1 - a[11] * s0) * inverse;
+	result.m[15] = (a[2] * s3 - a[6] * s1 + a[10] * s0) * inverse;
+	return result;
+}
+
+Mat3 Mat4::UpperLeft() const
+{
+	Mat3 result;
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+			result.m[column * 3 + row] = m[column * 4 + row];
+	}
+	return result;
+}
+
+Quat Quat::FromAxisAngle(const Vec3& axis, float radians)
+{
+	Vec3 n = Normalize(axis);
+	float s = std::sin(radians * 0.5f);
+	return Quat(n.x * s, n.y * s, n.z * s, std::cos(radians * 0.5f));
+}
+
+Quat Quat::operator*(const Quat& o) const
+{
+	return Quat(w * o.x + x * o.w + y * o.z - z * o.y,
+		w * o.y - x * o.z + y * o.w + z * o.x,
+		w * o.z + x * o.y - y * o.x + z * o.w,
+		w * o.w - x * o.x - y * o.y - z * o.z);
+}
+
+Vec3 Quat::Rotate(const Vec3& v) const
+{
+	// v + 2w (q x v) + 2 q x (q x v), cheaper than two quaternion products
+	Vec3 q(x, y, z);
+	Vec3 t = Cross(q, v) * 2.0f;
+	return v + t * w + Cross(q, t);
+}
+
+Quat Quat::Normalized() const
+{
+	float inverse = 1.0f / std::sqrt(x * x + y * y + z * z + w * w);
+	return Quat(x * inverse, y * inverse, z * inverse, w * inverse);
+}
+
+Quat Slerp(const Quat& a, const Quat& b, float t)
+{
+	float cosine = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	// q and -q are the same rotation, flip one to take the short way around
+	float sign = cosine < 0.0f ? -1.0f : 1.0f;
+	cosine *= sign;
+
+	float wa = 1.0f - t, wb = t * sign;
+	if (cosine < 0.9995f)
+	{
+		float angle = std::acos(cosine);
+		float inverseSine = 1.0f / std::sin(angle);
+		wa = std::sin((1.0f - t) * angle) * inverseSine;
+		wb = std::sin(t * angle) * inverseSine * sign;
+	}
+	return Quat(a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb).Normalized();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SIMD_MATH_SSE2
+#endif
+
+// Small vector, matrix and quaternion types for scene code
+// Vec4, Mat4 and Quat are 16 byte aligned and use SSE2 when it is there, everything else is plain scalar code
+// Matrices are column major like OpenGL, Data() can go straight into glUniformMatrix4fv or an ObjectRecord
+
+struct Vec2
+{
+	float x, y;
+
+	Vec2() : x(0.0f), y(0.0f) {}
+	Vec2(float x, float y) : x(x), y(y) {}
+
+	inline Vec2 operator+(const Vec2& o) const { return Vec2(x + o.x, y + o.y); }
+	inline Vec2 operator-(const Vec2& o) const { return Vec2(x - o.x, y - o.y); }
+	inline Vec2 operator*(float s) const { return Vec2(x * s, y * s); }
+	inline const float* Data() const { return &x; }
+};
+
+struct Vec3
+{
+	float x, y, z;
+
+	Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+	Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+	inline Vec3 operator+(const Vec3& o) const { return Vec3(x + o.x, y + o.y, z + o.z); }
+	inline Vec3 operator-(const Vec3& o) const { return Vec3(x - o.x, y - o.y, z - o.z); }
+	inline Vec3 operator*(float s) const { return Vec3(x * s, y * s, z * s); }
+	inline Vec3 operator-() const { return Vec3(-x, -y, -z); }
+	inline const float* Data() const { return &x; }
+};
+
+struct alignas(16) Vec4
+{
+	float x, y, z, w;
+
+	Vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+	Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+	Vec4(const Vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+#ifdef SIMD_MATH_SSE2
+	explicit Vec4(__m128 v) { _mm_store_ps(&x, v); }
+	inline __m128 Load() const { return _mm_load_ps(&x); }
+
+	inline Vec4 operator+(const Vec4& o) const { return Vec4(_mm_add_ps(Load(), o.Load())); }
+	inline Vec4 operator-(const Vec4& o) const { return Vec4(_mm_sub_ps(Load(), o.Load())); }
+	inline Vec4 operator*(const Vec4& o) const { return Vec4(_mm_mul_ps(Load(), o.Load())); }
+	inline Vec4 operator*(float s) const { return Vec4(_mm_mul_ps(Load(), _mm_set1_ps(s))); }
+#else
+	inline Vec4 operator+(const Vec4& o) const { return Vec4(x + o.x, y + o.y, z + o.z, w + o.w); }
+	inline Vec4 operator-(const Vec4& o) const { return Vec4(x - o.x, y - o.y, z - o.z, w - o.w); }
+	inline Vec4 operator*(const Vec4& o) const { return Vec4(x * o.x, y * o.y, z * o.z, w * o.w); }
+	inline Vec4 operator*(float s) const { return Vec4(x * s, y * s, z * s, w * s); }
+#endif
+	inline Vec3 XYZ() const { return Vec3(x, y, z); }
+	inline const float* Data() const { return &x; }
+};
+
+inline float Dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline Vec3 Cross(const Vec3& a, const Vec3& b) { return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+inline float Length(const Vec2& v) { return std::sqrt(Dot(v, v)); }
+inline float Length(const Vec3& v) { return std::sqrt(Dot(v, v)); }
+inline float Length(const Vec4& v) { return std::sqrt(Dot(v, v)); }
+inline Vec2 Normalize(const Vec2& v) { return v * (1.0f / Length(v)); }
+inline Vec3 Normalize(const Vec3& v) { return v * (1.0f / Length(v)); }
+inline Vec4 Normalize(const Vec4& v) { return v * (1.0f / Length(v)); }
+
+struct Quat;
+
+struct Mat3
+{
+	float m[9];
+
+	static Mat3 Identity();
+
+	Mat3 operator*(const Mat3& o) const;
+	Vec3 operator*(const Vec3& v) const;
+	Mat3 Transpose() const;
+	inline const float* Data() const { return m; }
+};
+
+struct alignas(16) Mat4
+{
+	float m[16];
+
+	static Mat4 Identity();
+	static Mat4 Translation(const Vec3& t);
+	static Mat4 Scale(const Vec3& s);
+	static Mat4 Rotation(const Quat& q);
+	// Right handed with the camera looking down -z, depth mapped to [-1, 1] like glFrustum
+	static Mat4 Perspective(float fovY, float aspect, float nearPlane, float farPlane);
+	static Mat4 Orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane);
+	static Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
+
+	Mat4 operator*(const Mat4& o) const;
+	Vec4 operator*(const Vec4& v) const;
+	// Affine transform of a point, w is taken as 1 and not divided out
+	Vec3 TransformPoint(const Vec3& p) const;
+	Vec3 TransformDirection(const Vec3& d) const;
+	Mat4 Transpose() const;
+	// General inverse through cofactors, returns the identity for a singular matrix
+	Mat4 Inverse() const;
+	Mat3 UpperLeft() const;
+	inline const float* Data() const { return m; }
+};
+
+struct alignas(16) Quat
+{
+	float x, y, z, w;
+
+	Quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+	Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	static Quat FromAxisAngle(const Vec3& axis, float radians);
+
+	Quat operator*(const Quat& o) const;
+	Vec3 Rotate(const Vec3& v) const;
+	inline Quat Conjugate() const { return Quat(-x, -y, -z, w); }
+	Quat Normalized() const;
+};
+
+// Shortest arc interpolation, falls back to a normalized lerp when the rotations are almost the same
+Quat Slerp(const Quat& a, const Quat& b, float t);
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Fixed size lock free queue for exactly one producer thread and one consumer thread
+// At most Capacity items are in flight, which bounds how far the producer can run ahead
+// Push and pop never lock, only a consumer actually sleeping in Pop costs the producer a short lock to wake it
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+private:
+	// One spare slot tells a full queue apart from an empty one
+	static const size_t SlotCount = Capacity + 1;
+
+	T m_Slots[SlotCount];
+	alignas(64) std::atomic<size_t> m_Head; // Next slot to read, only the consumer moves it
+	alignas(64) std::atomic<size_t> m_Tail; // Next slot to write, only the producer moves it
+	std::atomic<bool> m_ConsumerSleeping; // Set by Pop under m_WaitMutex before it waits
+	std::mutex m_WaitMutex;
+	std::condition_variable m_NotEmpty;
+public:
+	SpscQueue()
+		: m_Head(0), m_Tail(0), m_ConsumerSleeping(false) {}
+
+	// Producer: false when the queue is full
+	bool TryPush(const T& item)
+	{
+		size_t tail = m_Tail.load(std::memory_order_relaxed);
+		size_t next = (tail + 1) % SlotCount;
+		if (next == m_Head.load(std::memory_order_acquire))
+			return false;
+
+		m_Slots[tail] = item;
+		// Sequentially consistent against the flag in Pop, either the consumer sees the new tail or this sees it going to sleep
+		m_Tail.store(next, std::memory_order_seq_cst);
+		if (m_ConsumerSleeping.load(std::memory_order_seq_cst))
+		{
+			// The consumer checks the queue under the lock, so once this has the lock it is either awake or waiting
+			std::lock_guard<std::mutex> lock(m_WaitMutex);
+			m_NotEmpty.notify_one();
+		}
+		return true;
+	}
+
+	// Consumer: false when the queue is empty
+	bool TryPop(T& item)
+	{
+		size_t head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_Tail.load(std::memory_order_acquire))
+			return false;
+
+		item = m_Slots[head];
+		m_Head.store((head + 1) % SlotCount, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer: sleeps until an item arrives
+	void Pop(T& item)
+	{
+		while (!TryPop(item))
+		{
+			std::unique_lock<std::mutex> lock(m_WaitMutex);
+			m_ConsumerSleeping.store(true, std::memory_order_seq_cst);
+			m_NotEmpty.wait(lock, [this]() { return m_Head.load(std::memory_order_relaxed) != m_Tail.load(std::memory_order_seq_cst); });
+			m_ConsumerSleeping.store(false, std::memory_order_relaxed);
+		}
+	}
+};
\ No newline at end of file
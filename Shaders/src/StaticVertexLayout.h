@@ -0,0 +1,75 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+#include <GL/glew.h>
+
+#include "VertexBufferLayout.h"
+
+// One attribute of a compile time layout, Size is the whole attribute in bytes
+template<unsigned int Type, unsigned int Count, bool Normalized, unsigned int Size>
+struct VertexAttribute
+{
+	static constexpr unsigned int type = Type;
+	static constexpr unsigned int count = Count;
+	static constexpr bool normalized = Normalized;
+	static constexpr unsigned int size = Size;
+};
+
+typedef VertexAttribute<GL_FLOAT, 1, false, 4> float1;
+typedef VertexAttribute<GL_FLOAT, 2, false, 8> float2;
+typedef VertexAttribute<GL_FLOAT, 3, false, 12> float3;
+typedef VertexAttribute<GL_FLOAT, 4, false, 16> float4;
+typedef VertexAttribute<GL_HALF_FLOAT, 2, false, 4> half2;
+typedef VertexAttribute<GL_HALF_FLOAT, 4, false, 8> half4;
+typedef VertexAttribute<GL_UNSIGNED_BYTE, 4, true, 4> unorm8x4;
+typedef VertexAttribute<GL_SHORT, 2, true, 4> snorm16x2;
+typedef VertexAttribute<GL_SHORT, 4, true, 8> snorm16x4;
+typedef VertexAttribute<GL_UNSIGNED_SHORT, 2, true, 4> unorm16x2;
+typedef VertexAttribute<GL_UNSIGNED_SHORT, 4, true, 8> unorm16x4;
+typedef VertexAttribute<GL_INT_2_10_10_10_REV, 4, true, 4> snorm1010102;
+
+// Vertex layout worked out entirely at compile time, e.g. Layout<float2, unorm8x4, half2>
+// Use VertexBufferLayout instead when the layout comes from data
+template<typename... Attributes>
+struct Layout
+{
+private:
+	template<unsigned int Index>
+	using AttributeAt = typename std::tuple_element<Index, std::tuple<Attributes...>>::type;
+
+	static constexpr unsigned int SumSizes(unsigned int end)
+	{
+		// Trailing 0 so an empty layout still has a valid array
+		constexpr unsigned int sizes[] = { Attributes::size..., 0 };
+		unsigned int total = 0;
+		for (unsigned int i = 0; i < end; i++)
+			total += sizes[i];
+		return total;
+	}
+public:
+	static constexpr unsigned int Count = sizeof...(Attributes);
+	static constexpr unsigned int Stride = SumSizes(sizeof...(Attributes));
+
+	template<unsigned int Index>
+	static constexpr unsigned int GetOffset() { return SumSizes(Index); }
+
+	template<unsigned int Index>
+	static constexpr VertexBufferElement GetElement()
+	{
+		return { AttributeAt<Index>::type, AttributeAt<Index>::count, AttributeAt<Index>::normalized, 0 };
+	}
+
+	// Build the equivalent runtime layout for code that only takes a VertexBufferLayout
+	static VertexBufferLayout ToRuntimeLayout()
+	{
+		VertexBufferLayout layout;
+		int expand[] = { (layout.Push(VertexBufferElement{ Attributes::type, Attributes::count, Attributes::normalized, 0 }), 0)..., 0 };
+		(void)expand;
+		return layout;
+	}
+};
+
+// Check a vertex struct against the layout that describes it
+#define ASSERT_VERTEX_LAYOUT(VertexType, LayoutType) \
+	static_assert(sizeof(VertexType) == LayoutType::Stride, #VertexType " does not match " #LayoutType)
@@ -0,0 +1,39 @@
+#include "Stats.h"
+#include "GpuMemory.h"
+
+RenderCounters& GetRenderCounters()
+{
+	// Zero initialised because it is static
+	static RenderCounters counters;
+	return counters;
+}
+
+// Bytes to mebibytes for printing
+static double ToMiB(unsigned long long bytes)
+{
+	return bytes / (1024.0 * 1024.0);
+}
+
+void PrintRenderStats(std::ostream& stream)
+{
+	GpuMemoryStats memory = GpuMemoryTracker::Get().GetStats();
+	stream << "[GPU Memory] current " << ToMiB(memory.current) << " MiB, peak " << ToMiB(memory.peak) << " MiB";
+	if (memory.budget)
+		stream << ", budget " << ToMiB(memory.budget) << " MiB, " << memory.refusedAllocations << " allocations refused";
+	stream << std::endl;
+	for (int i = 0; i < (int)GpuMemoryCategory::Count; i++)
+	{
+		stream << "    " << GpuMemoryTracker::GetCategoryName((GpuMemoryCategory)i) << ": "
+			<< ToMiB(memory.categoryCurrent[i]) << " MiB (peak " << ToMiB(memory.categoryPeak[i]) << " MiB)" << std::endl;
+	}
+
+	RenderCounters& counters = GetRenderCounters();
+	stream << "[GL] " << counters.glCalls << " calls" << std::endl;
+
+	unsigned long long hits = counters.vertexArrayCacheHits;
+	unsigned long long lookups = hits + counters.vertexArrayCacheMisses;
+	stream << "[Vertex Array Cache] " << counters.vertexArrayCacheSize << " arrays, " << hits << "/" << lookups << " hits";
+	if (lookups)
+		stream << " (" << 100.0 * hits / lookups << "%)";
+	stream << std::endl;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <atomic>
+#include <ostream>
+
+// Counters bumped by the renderer subsystems, safe to touch from any thread
+struct RenderCounters
+{
+	std::atomic<unsigned long long> glCalls; // Everything that went through GLCall
+	std::atomic<unsigned long long> vertexArrayCacheHits;
+	std::atomic<unsigned long long> vertexArrayCacheMisses;
+	std::atomic<unsigned long long> vertexArrayCacheSize; // Vertex arrays currently held by caches
+};
+
+RenderCounters& GetRenderCounters();
+
+// Write every renderer statistic we collect in a readable form
+void PrintRenderStats(std::ostream& stream);
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "Texture.h"
+#include "Renderer.h"
+#include "GpuMemory.h"
+
+#include <algorithm>
+
+// Immutable storage is core in 4.2, the context we ask for is 3.3 so check for the extension
+static bool HasTextureStorage()
+{
+	return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+}
+
+// Client side format and type matching each supported internal format
+static void GetUploadFormat(unsigned int internalFormat, GLenum& format, GLenum& type)
+{
+	type = GL_UNSIGNED_BYTE;
+	switch (internalFormat)
+	{
+		case GL_R8: format = GL_RED; return;
+		case GL_RG8: format = GL_RG; return;
+		case GL_RGB8: case GL_SRGB8: format = GL_RGB; return;
+		case GL_RGBA8: case GL_SRGB8_ALPHA8: format = GL_RGBA; return;
+		case GL_R16F: format = GL_RED; type = GL_HALF_FLOAT; return;
+		case GL_RGBA16F: format = GL_RGBA; type = GL_HALF_FLOAT; return;
+		case GL_R32F: format = GL_RED; type = GL_FLOAT; return;
+		case GL_RGBA32F: format = GL_RGBA; type = GL_FLOAT; return;
+	}
+
+	ASSERT(false);
+	format = GL_RGBA;
+}
+
+unsigned int Texture::GetBytesPerPixel(unsigned int internalFormat)
+{
+	switch (internalFormat)
+	{
+		case GL_R8: return 1;
+		case GL_RG8: case GL_R16F: return 2;
+		case GL_RGB8: case GL_SRGB8: return 3;
+		case GL_RGBA8: case GL_SRGB8_ALPHA8: case GL_R32F: return 4;
+		// Render target formats, never uploaded to but still counted
+		case GL_RGB10_A2: case GL_R11F_G11F_B10F: return 4;
+		case GL_DEPTH_COMPONENT24: case GL_DEPTH24_STENCIL8: case GL_DEPTH_COMPONENT32F: return 4;
+		case GL_RGBA16F: return 8;
+		case GL_RGBA32F: return 16;
+	}
+
+	ASSERT(false);
+	return 0;
+}
+
+unsigned int Texture::GetFullLevelCount(unsigned int width, unsigned int height)
+{
+	unsigned int levels = 1;
+	for (unsigned int size = std::max(width, height); size > 1; size >>= 1)
+		levels++;
+	return levels;
+}
+
+Texture::Texture(unsigned int target, unsigned int width, unsigned int height, unsigned int layers, unsigned int internalFormat, unsigned int levelCount)
+	: m_Renderer_Id(0), m_Target(target), m_InternalFormat(internalFormat), m_Width(width), m_Height(height), m_Layers(layers), m_Size(0), m_Allocated(true)
+{
+	ASSERT(width > 0 && height > 0 && layers > 0);
+	m_LevelCount = levelCount ? std::min(levelCount, GetFullLevelCount(width, height)) : GetFullLevelCount(width, height);
+	m_ResidentLevel = m_LevelCount;
+	for (unsigned int level = 0; level < m_LevelCount; level++)
+	{
+		m_MissingLayers[level] = layers;
+		m_Size += (unsigned long long)GetLevelSize(level) * layers;
+	}
+
+	// Counted before the GL allocation so the budget can refuse it, the texture then only gets a name
+	if (!GpuMemoryTracker::Get().TryAllocate(GpuMemoryCategory::Texture, m_Size))
+	{
+		m_Size = 0;
+		m_Allocated = false;
+		GLCall(glGenTextures(1, &m_Renderer_Id));
+		return;
+	}
+
+	const bool isArray = target == GL_TEXTURE_2D_ARRAY;
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glCreateTextures(target, 1, &m_Renderer_Id));
+		if (isArray)
+		{
+			GLCall(glTextureStorage3D(m_Renderer_Id, m_LevelCount, internalFormat, width, height, layers));
+		}
+		else
+		{
+			GLCall(glTextureStorage2D(m_Renderer_Id, m_LevelCount, internalFormat, width, height));
+		}
+		GLCall(glTextureParameteri(m_Renderer_Id, GL_TEXTURE_BASE_LEVEL, m_LevelCount - 1));
+	}
+	else
+	{
+		GLCall(glGenTextures(1, &m_Renderer_Id));
+		GLCall(glBindTexture(target, m_Renderer_Id));
+		if (HasTextureStorage())
+		{
+			if (isArray)
+			{
+				GLCall(glTexStorage3D(target, m_LevelCount, internalFormat, width, height, layers));
+			}
+			else
+			{
+				GLCall(glTexStorage2D(target, m_LevelCount, internalFormat, width, height));
+			}
+		}
+		else
+		{
+			// Same shape as immutable storage, allocated level by level
+			GLenum format, type;
+			GetUploadFormat(internalFormat, format, type);
+			for (unsigned int level = 0; level < m_LevelCount; level++)
+			{
+				if (isArray)
+				{
+					GLCall(glTexImage3D(target, level, internalFormat, GetWidth(level), GetHeight(level), layers, 0, format, type, nullptr));
+				}
+				else
+				{
+					GLCall(glTexImage2D(target, level, internalFormat, GetWidth(level), GetHeight(level), 0, format, type, nullptr));
+				}
+			}
+			GLCall(glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, m_LevelCount - 1));
+		}
+		// Nothing is loaded yet, keep sampling on the smallest level until the streamer lowers it
+		GLCall(glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, m_LevelCount - 1));
+		GLCall(glBindTexture(target, 0));
+	}
+}
+
+Texture::~Texture()
+{
+	GLCall(glDeleteTextures(1, &m_Renderer_Id));
+	GpuMemoryTracker::Get().Free(GpuMemoryCategory::Texture, m_Size);
+}
+
+void Texture::Bind(unsigned int slot) const
+{
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glBindTextureUnit(slot, m_Renderer_Id));
+		return;
+	}
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(m_Target, m_Renderer_Id));
+}
+
+void Texture::Unbind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(m_Target, 0));
+}
+
+// pixels is a client pointer, or an offset into the bound GL_PIXEL_UNPACK_BUFFER when the streamer uploads
+void Texture::Upload(unsigned int level, unsigned int layer, const void* pixels)
+{
+	ASSERT(level < m_LevelCount && layer < m_Layers);
+	if (!m_Allocated)
+		return;
+	GLenum format, type;
+	GetUploadFormat(m_InternalFormat, format, type);
+
+	// Rows of RGB8 and R8 levels are not 4 byte aligned in general
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	const bool isArray = m_Target == GL_TEXTURE_2D_ARRAY;
+	if (GLHasDirectStateAccess())
+	{
+		if (isArray)
+		{
+			GLCall(glTextureSubImage3D(m_Renderer_Id, level, 0, 0, layer, GetWidth(level), GetHeight(level), 1, format, type, pixels));
+		}
+		else
+		{
+			GLCall(glTextureSubImage2D(m_Renderer_Id, level, 0, 0, GetWidth(level), GetHeight(level), format, type, pixels));
+		}
+	}
+	else
+	{
+		GLCall(glBindTexture(m_Target, m_Renderer_Id));
+		if (isArray)
+		{
+			GLCall(glTexSubImage3D(m_Target, level, 0, 0, layer, GetWidth(level), GetHeight(level), 1, format, type, pixels));
+		}
+		else
+		{
+			GLCall(glTexSubImage2D(m_Target, level, 0, 0, GetWidth(level), GetHeight(level), format, type, pixels));
+		}
+		GLCall(glBindTexture(m_Target, 0));
+	}
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+
+	MarkLoaded(level);
+}
+
+void Texture::MarkLoaded(unsigned int level)
+{
+	if (m_MissingLayers[level] > 0)
+		m_MissingLayers[level]--;
+
+	// The resident level only moves down through levels that are complete, a fine level arriving early just waits
+	unsigned int resident = m_ResidentLevel;
+	while (resident > 0 && m_MissingLayers[resident - 1] == 0)
+		resident--;
+	if (resident == m_ResidentLevel)
+		return;
+	m_ResidentLevel = resident;
+
+	// GL orders this after the upload above, so the new base level is never sampled before its data is there
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glTextureParameteri(m_Renderer_Id, GL_TEXTURE_BASE_LEVEL, m_ResidentLevel));
+		return;
+	}
+	GLCall(glBindTexture(m_Target, m_Renderer_Id));
+	GLCall(glTexParameteri(m_Target, GL_TEXTURE_BASE_LEVEL, m_ResidentLevel));
+	GLCall(glBindTexture(m_Target, 0));
+}
+
+void Texture::SetData(unsigned int level, unsigned int layer, const void* pixels)
+{
+	// A synchronous upload must not read from whatever pixel buffer happens to be bound
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	Upload(level, layer, pixels);
+}
+
+void Texture::GenerateMipmaps()
+{
+	if (!m_Allocated)
+		return;
+
+	// Base level has to be 0 for the generated chain to start from level 0
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glTextureParameteri(m_Renderer_Id, GL_TEXTURE_BASE_LEVEL, 0));
+		GLCall(glGenerateTextureMipmap(m_Renderer_Id));
+	}
+	else
+	{
+		GLCall(glBindTexture(m_Target, m_Renderer_Id));
+		GLCall(glTexParameteri(m_Target, GL_TEXTURE_BASE_LEVEL, 0));
+		GLCall(glGenerateMipmap(m_Target));
+		GLCall(glBindTexture(m_Target, 0));
+	}
+
+	for (unsigned int level = 0; level < m_LevelCount; level++)
+		m_MissingLayers[level] = 0;
+	m_ResidentLevel = 0;
+}
+
+Texture2D::Texture2D(unsigned int width, unsigned int height, unsigned int internalFormat, unsigned int levelCount)
+	: Texture(GL_TEXTURE_2D, width, height, 1, internalFormat, levelCount)
+{
+}
+
+TextureArray::TextureArray(unsigned int width, unsigned int height, unsigned int layers, unsigned int internalFormat, unsigned int levelCount)
+	: Texture(GL_TEXTURE_2D_ARRAY, width, height, layers, internalFormat, levelCount)
+{
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <GL/glew.h>
+
+class TextureStreamer;
+
+// Immutable storage texture whose mip levels can arrive one at a time, coarse to fine
+// Sampling is clamped to the finest level whose data is complete for every layer, so a texture can be drawn with
+// as soon as its smallest level is in and sharpens as the streamer fills in the rest
+class Texture
+{
+	friend class TextureStreamer;
+private:
+	unsigned int m_Renderer_Id;
+	unsigned int m_Target; // GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+	unsigned int m_InternalFormat;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_Layers;
+	unsigned int m_LevelCount;
+	unsigned int m_ResidentLevel; // Finest level with all its layers loaded, m_LevelCount while nothing is
+	unsigned int m_MissingLayers[32]; // Layers still to load for each level
+	unsigned long long m_Size;
+	bool m_Allocated; // False when the memory budget refused the storage, uploads are then dropped
+
+	void Upload(unsigned int level, unsigned int layer, const void* pixels);
+	void MarkLoaded(unsigned int level);
+protected:
+	// levelCount 0 allocates the full mip chain
+	// Over the memory budget the texture is created without storage and never becomes resident, check IsAllocated
+	Texture(unsigned int target, unsigned int width, unsigned int height, unsigned int layers, unsigned int internalFormat, unsigned int levelCount);
+public:
+	virtual ~Texture();
+
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
+	void Bind(unsigned int slot = 0) const;
+	void Unbind(unsigned int slot = 0) const;
+
+	// Synchronous upload of one level of one layer, pixels must hold GetLevelSize(level) bytes
+	void SetData(unsigned int level, unsigned int layer, const void* pixels);
+	// Fill every level below 0 from level 0, making the whole chain resident
+	void GenerateMipmaps();
+
+	inline unsigned int GetRendererID() const { return m_Renderer_Id; }
+	inline unsigned int GetTarget() const { return m_Target; }
+	inline unsigned int GetInternalFormat() const { return m_InternalFormat; }
+	inline unsigned int GetWidth(unsigned int level = 0) const { return m_Width >> level ? m_Width >> level : 1; }
+	inline unsigned int GetHeight(unsigned int level = 0) const { return m_Height >> level ? m_Height >> level : 1; }
+	inline unsigned int GetLayerCount() const { return m_Layers; }
+	inline unsigned int GetLevelCount() const { return m_LevelCount; }
+	inline unsigned int GetResidentLevel() const { return m_ResidentLevel; }
+	inline bool IsResident() const { return m_ResidentLevel < m_LevelCount; }
+	inline bool IsFullyResident() const { return m_ResidentLevel == 0; }
+	// Bytes of one layer of one level
+	inline unsigned int GetLevelSize(unsigned int level) const { return GetWidth(level) * GetHeight(level) * GetBytesPerPixel(m_InternalFormat); }
+	inline unsigned long long GetSize() const { return m_Size; }
+	inline bool IsAllocated() const { return m_Allocated; }
+
+	static unsigned int GetBytesPerPixel(unsigned int internalFormat);
+	static unsigned int GetFullLevelCount(unsigned int width, unsigned int height);
+};
+
+class Texture2D : public Texture
+{
+public:
+	Texture2D(unsigned int width, unsigned int height, unsigned int internalFormat = GL_RGBA8, unsigned int levelCount = 0);
+};
+
+// All layers share one size, format and mip chain, and draws pick a layer instead of a texture unit
+class TextureArray : public Texture
+{
+public:
+	TextureArray(unsigned int width, unsigned int height, unsigned int layers, unsigned int internalFormat = GL_RGBA8, unsigned int levelCount = 0);
+};
\ No newline at end of file
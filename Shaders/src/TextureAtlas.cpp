@@ -0,0 +1,172 @@
+#include "TextureAtlas.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+static bool Contains(const AtlasRect& outer, const AtlasRect& inner)
+{
+	return inner.x >= outer.x && inner.y >= outer.y
+		&& inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+}
+
+AtlasPacker::AtlasPacker(unsigned int width, unsigned int height, unsigned int padding)
+	: m_Width(width), m_Height(height), m_Padding(padding)
+{
+	Reset();
+}
+
+void AtlasPacker::Reset()
+{
+	m_FreeRects.clear();
+	m_FreeRects.push_back({ 0, 0, m_Width, m_Height });
+}
+
+bool AtlasPacker::Pack(unsigned int width, unsigned int height, AtlasRect& rect)
+{
+	// Padding is not needed past the edge of the page
+	unsigned int best = 0xFFFFFFFF, bestLong = 0xFFFFFFFF;
+	AtlasRect placed = {};
+	for (const AtlasRect& freeRect : m_FreeRects)
+	{
+		unsigned int paddedWidth = std::min(width + m_Padding, m_Width - freeRect.x);
+		unsigned int paddedHeight = std::min(height + m_Padding, m_Height - freeRect.y);
+		if (width > freeRect.width || height > freeRect.height || paddedWidth > freeRect.width || paddedHeight > freeRect.height)
+			continue;
+
+		// Best short side fit, the leftover sliver along the tighter side is as small as possible
+		unsigned int leftoverX = freeRect.width - paddedWidth, leftoverY = freeRect.height - paddedHeight;
+		unsigned int shortSide = std::min(leftoverX, leftoverY), longSide = std::max(leftoverX, leftoverY);
+		if (shortSide < best || (shortSide == best && longSide < bestLong))
+		{
+			best = shortSide;
+			bestLong = longSide;
+			placed = { freeRect.x, freeRect.y, paddedWidth, paddedHeight };
+		}
+	}
+
+	if (best == 0xFFFFFFFF)
+		return false;
+
+	SplitFreeRects(placed);
+	PruneFreeRects();
+	rect = { placed.x, placed.y, width, height };
+	return true;
+}
+
+void AtlasPacker::SplitFreeRects(const AtlasRect& used)
+{
+	// Replace every free rect the new one overlaps by the up to four maximal rects around it
+	std::vector<AtlasRect> result;
+	result.reserve(m_FreeRects.size() + 4);
+	for (const AtlasRect& freeRect : m_FreeRects)
+	{
+		if (used.x >= freeRect.x + freeRect.width || used.x + used.width <= freeRect.x
+			|| used.y >= freeRect.y + freeRect.height || used.y + used.height <= freeRect.y)
+		{
+			result.push_back(freeRect);
+			continue;
+		}
+
+		if (used.x > freeRect.x)
+			result.push_back({ freeRect.x, freeRect.y, used.x - freeRect.x, freeRect.height });
+		if (used.x + used.width < freeRect.x + freeRect.width)
+			result.push_back({ used.x + used.width, freeRect.y, freeRect.x + freeRect.width - used.x - used.width, freeRect.height });
+		if (used.y > freeRect.y)
+			result.push_back({ freeRect.x, freeRect.y, freeRect.width, used.y - freeRect.y });
+		if (used.y + used.height < freeRect.y + freeRect.height)
+			result.push_back({ freeRect.x, used.y + used.height, freeRect.width, freeRect.y + freeRect.height - used.y - used.height });
+	}
+	m_FreeRects.swap(result);
+}
+
+void AtlasPacker::PruneFreeRects()
+{
+	// Drop free rects that are fully inside another one, keeping one copy of duplicates
+	for (size_t i = 0; i < m_FreeRects.size(); i++)
+	{
+		for (size_t j = i + 1; j < m_FreeRects.size();)
+		{
+			if (Contains(m_FreeRects[i], m_FreeRects[j]))
+			{
+				m_FreeRects.erase(m_FreeRects.begin() + j);
+				continue;
+			}
+			if (Contains(m_FreeRects[j], m_FreeRects[i]))
+			{
+				m_FreeRects.erase(m_FreeRects.begin() + i);
+				i--;
+				break;
+			}
+			j++;
+		}
+	}
+}
+
+TextureAtlas::TextureAtlas(unsigned int pageWidth, unsigned int pageHeight, unsigned int padding)
+	: m_PageWidth(pageWidth), m_PageHeight(pageHeight), m_Padding(padding)
+{
+}
+
+unsigned int TextureAtlas::Add(const void* pixels, unsigned int width, unsigned int height)
+{
+	if (width > m_PageWidth || height > m_PageHeight)
+		return InvalidRegion;
+
+	// Try every open page before starting a new one, an image that did not fit earlier may still fit a gap
+	AtlasRect rect;
+	unsigned int page = 0;
+	while (page < m_Packers.size() && !m_Packers[page].Pack(width, height, rect))
+		page++;
+	if (page == m_Packers.size())
+	{
+		m_Packers.emplace_back(m_PageWidth, m_PageHeight, m_Padding);
+		m_Pages.emplace_back((size_t)m_PageWidth * m_PageHeight * 4, 0);
+		bool packed = m_Packers.back().Pack(width, height, rect);
+		ASSERT(packed);
+	}
+
+	const unsigned char* source = (const unsigned char*)pixels;
+	unsigned char* destination = m_Pages[page].data();
+	for (unsigned int row = 0; row < height; row++)
+		std::memcpy(destination + ((size_t)(rect.y + row) * m_PageWidth + rect.x) * 4, source + (size_t)row * width * 4, width * 4);
+
+	AtlasRegion region;
+	region.layer = page;
+	region.u0 = (float)rect.x / m_PageWidth;
+	region.v0 = (float)rect.y / m_PageHeight;
+	region.u1 = (float)(rect.x + width) / m_PageWidth;
+	region.v1 = (float)(rect.y + height) / m_PageHeight;
+	m_Regions.push_back(region);
+	return (unsigned int)m_Regions.size() - 1;
+}
+
+void TextureAtlas::Add(const AtlasImage* images, unsigned int count, unsigned int* regions)
+{
+	// Largest side first, then largest area, the usual order for offline MaxRects packing
+	std::vector<unsigned int> order(count);
+	for (unsigned int i = 0; i < count; i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [images](unsigned int a, unsigned int b) {
+		unsigned int sideA = std::max(images[a].width, images[a].height), sideB = std::max(images[b].width, images[b].height);
+		if (sideA != sideB)
+			return sideA > sideB;
+		return images[a].width * images[a].height > images[b].width * images[b].height;
+	});
+
+	for (unsigned int i : order)
+		regions[i] = Add(images[i].pixels, images[i].width, images[i].height);
+}
+
+void TextureAtlas::Build(unsigned int levelCount)
+{
+	m_Texture.reset();
+	if (m_Pages.empty())
+		return;
+
+	m_Texture.reset(new TextureArray(m_PageWidth, m_PageHeight, (unsigned int)m_Pages.size(), GL_RGBA8, levelCount));
+	for (unsigned int layer = 0; layer < m_Pages.size(); layer++)
+		m_Texture->SetData(0, layer, m_Pages[layer].data());
+	if (m_Texture->GetLevelCount() > 1)
+		m_Texture->GenerateMipmaps();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Texture.h"
+
+struct AtlasRect
+{
+	unsigned int x, y, width, height;
+};
+
+// MaxRects bin packer (Jylanki 2010) with the best short side fit heuristic
+// Keeps every maximal free rectangle, so it packs tighter than a skyline at the cost of a longer free list
+class AtlasPacker
+{
+private:
+	unsigned int m_Width;
+	unsigned int m_Height;
+	unsigned int m_Padding;
+	std::vector<AtlasRect> m_FreeRects;
+
+	void SplitFreeRects(const AtlasRect& used);
+	void PruneFreeRects();
+public:
+	// padding is left free to the right of and above every rect
+	AtlasPacker(unsigned int width, unsigned int height, unsigned int padding = 1);
+
+	// False when there is no room, rect gets the position of the unpadded area
+	bool Pack(unsigned int width, unsigned int height, AtlasRect& rect);
+	void Reset();
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+};
+
+// Where one image ended up: the array layer and its texture coordinates on that layer
+struct AtlasRegion
+{
+	unsigned int layer;
+	float u0, v0, u1, v1;
+};
+
+// RGBA8 image to pack, rows bottom to top like glTexImage2D expects
+struct AtlasImage
+{
+	const void* pixels;
+	unsigned int width;
+	unsigned int height;
+};
+
+// Packs many small RGBA8 images into the layers of one TextureArray, opening a new layer whenever one fills up
+// Add images one by one at load time, or all at once at build time where sorting them by size packs tighter
+// Build uploads everything added so far, call it again after adding more
+class TextureAtlas
+{
+private:
+	unsigned int m_PageWidth;
+	unsigned int m_PageHeight;
+	unsigned int m_Padding;
+	std::vector<AtlasPacker> m_Packers;
+	std::vector<std::vector<unsigned char>> m_Pages; // CPU copy of every layer until Build
+	std::vector<AtlasRegion> m_Regions;
+	std::unique_ptr<TextureArray> m_Texture;
+public:
+	static const unsigned int InvalidRegion = 0xFFFFFFFF;
+
+	TextureAtlas(unsigned int pageWidth = 2048, unsigned int pageHeight = 2048, unsigned int padding = 2);
+
+	// Returns the region index, InvalidRegion if the image is larger than a page
+	unsigned int Add(const void* pixels, unsigned int width, unsigned int height);
+	// Adds largest first and writes the region index of every image to regions
+	void Add(const AtlasImage* images, unsigned int count, unsigned int* regions);
+
+	// Create the texture array and upload every layer, levelCount 0 builds the full mip chain
+	void Build(unsigned int levelCount = 1);
+
+	inline const AtlasRegion& GetRegion(unsigned int region) const { return m_Regions[region]; }
+	inline unsigned int GetRegionCount() const { return (unsigned int)m_Regions.size(); }
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	inline const TextureArray* GetTexture() const { return m_Texture.get(); }
+};
\ No newline at end of file
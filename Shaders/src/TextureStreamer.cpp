@@ -0,0 +1,166 @@
+#include "TextureStreamer.h"
+#include "Texture.h"
+#include "Renderer.h"
+#include "GpuMemory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+TextureStreamer::TextureStreamer(unsigned int stagingBufferSize, unsigned int stagingBufferCount)
+	: m_NextSequence(0), m_StagingBufferSize(stagingBufferSize), m_CurrentStagingBuffer(0), m_UploadedBytes(0)
+{
+	m_StagingBuffers.resize(stagingBufferCount);
+	for (StagingBuffer& staging : m_StagingBuffers)
+	{
+		staging.used = 0;
+		staging.fence = nullptr;
+		GLCall(glGenBuffers(1, &staging.bufferId));
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.bufferId));
+		GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, stagingBufferSize, nullptr, GL_STREAM_DRAW));
+	}
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	GpuMemoryTracker::Get().Allocate(GpuMemoryCategory::Other, (unsigned long long)stagingBufferSize * stagingBufferCount);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for (StagingBuffer& staging : m_StagingBuffers)
+	{
+		if (staging.fence)
+		{
+			GLCall(glDeleteSync((GLsync)staging.fence));
+		}
+		GLCall(glDeleteBuffers(1, &staging.bufferId));
+	}
+	GpuMemoryTracker::Get().Free(GpuMemoryCategory::Other, (unsigned long long)m_StagingBufferSize * m_StagingBuffers.size());
+}
+
+void TextureStreamer::Enqueue(Texture* texture, unsigned int level, unsigned int layer, std::vector<unsigned char>&& pixels)
+{
+	ASSERT(pixels.size() >= texture->GetLevelSize(level));
+	// A texture the memory budget refused has nowhere to put the pixels
+	if (!texture->IsAllocated())
+		return;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Requests.push_back({ texture, level, layer, m_NextSequence++, std::move(pixels) });
+	std::push_heap(m_Requests.begin(), m_Requests.end(), RequestOrder());
+}
+
+void TextureStreamer::Cancel(const Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Requests.erase(std::remove_if(m_Requests.begin(), m_Requests.end(),
+		[texture](const Request& request) { return request.texture == texture; }), m_Requests.end());
+	std::make_heap(m_Requests.begin(), m_Requests.end(), RequestOrder());
+}
+
+unsigned int TextureStreamer::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return (unsigned int)m_Requests.size();
+}
+
+// Free the buffer for refilling if the GPU is done reading from it
+bool TextureStreamer::RetireStagingBuffer(StagingBuffer& staging)
+{
+	if (!staging.fence)
+		return true;
+
+	GLCall(GLenum result = glClientWaitSync((GLsync)staging.fence, 0, 0));
+	if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		return false;
+	GLCall(glDeleteSync((GLsync)staging.fence));
+	staging.fence = nullptr;
+	staging.used = 0;
+	return true;
+}
+
+// Carve size bytes out of the current staging buffer, moving on to the next one in the ring once it is full
+bool TextureStreamer::AcquireStagingSpace(unsigned int size, StagingBuffer*& buffer, unsigned int& offset)
+{
+	StagingBuffer* current = &m_StagingBuffers[m_CurrentStagingBuffer];
+	if (!RetireStagingBuffer(*current))
+		return false;
+
+	// 16 byte offsets keep every row of every format aligned for the unpack
+	unsigned int aligned = (current->used + 15) & ~15u;
+	if (aligned + size > m_StagingBufferSize)
+	{
+		CloseStagingBuffer();
+		current = &m_StagingBuffers[m_CurrentStagingBuffer];
+		if (!RetireStagingBuffer(*current))
+			return false;
+		aligned = 0;
+	}
+
+	current->used = aligned + size;
+	buffer = current;
+	offset = aligned;
+	return true;
+}
+
+// Fence everything uploaded from the current buffer and move on to the next one
+void TextureStreamer::CloseStagingBuffer()
+{
+	StagingBuffer& current = m_StagingBuffers[m_CurrentStagingBuffer];
+	if (current.used == 0 || current.fence)
+		return;
+
+	GLCall(current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_CurrentStagingBuffer = (m_CurrentStagingBuffer + 1) % m_StagingBuffers.size();
+}
+
+void TextureStreamer::Process(double budgetMilliseconds)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	while (true)
+	{
+		Request request;
+		StagingBuffer* staging = nullptr;
+		unsigned int offset = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Requests.empty())
+				break;
+
+			// Peek first, a request that has to wait for staging space stays queued
+			const Request& next = m_Requests.front();
+			unsigned int nextSize = next.texture->GetLevelSize(next.level);
+			if (nextSize <= m_StagingBufferSize && !AcquireStagingSpace(nextSize, staging, offset))
+				break;
+
+			std::pop_heap(m_Requests.begin(), m_Requests.end(), RequestOrder());
+			request = std::move(m_Requests.back());
+			m_Requests.pop_back();
+		}
+
+		unsigned int size = request.texture->GetLevelSize(request.level);
+		if (staging)
+		{
+			// Nothing is still reading this part of the buffer, so it can be written without waiting or orphaning
+			GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging->bufferId));
+			GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+			std::memcpy(mapped, request.pixels.data(), size);
+			GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+			// With a pixel unpack buffer bound the data pointer is an offset into it
+			request.texture->Upload(request.level, request.layer, (const void*)(size_t)offset);
+			GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		}
+		else
+		{
+			request.texture->SetData(request.level, request.layer, request.pixels.data());
+		}
+		m_UploadedBytes += size;
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		if (elapsed.count() >= budgetMilliseconds)
+			break;
+	}
+
+	// The uploads of this call are all issued, one fence covers them
+	CloseStagingBuffer();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+class Texture;
+
+// Streams texture mip levels into their immutable storage through a ring of pixel buffer objects
+// Any thread can enqueue decoded level data, the render thread packs it back to back into the current pixel buffer and
+// issues the upload from there, so glTexSubImage returns without waiting on the copy. Coarse levels always go first, across all textures,
+// which makes every texture usable early and lets Texture raise its resident level as the finer ones arrive
+class TextureStreamer
+{
+private:
+	struct Request
+	{
+		Texture* texture;
+		unsigned int level;
+		unsigned int layer;
+		unsigned long long sequence; // Keeps requests of the same level in submission order
+		std::vector<unsigned char> pixels;
+	};
+
+	// Heap order, the request that should go next compares greatest
+	struct RequestOrder
+	{
+		bool operator()(const Request& a, const Request& b) const
+		{
+			return a.level != b.level ? a.level < b.level : a.sequence > b.sequence;
+		}
+	};
+
+	// Filled with as many levels as fit, then fenced once and left alone until the GPU has read all of them
+	struct StagingBuffer
+	{
+		unsigned int bufferId;
+		unsigned int used; // Bytes handed out since the buffer was last free
+		void* fence; // GLsync after the last upload read from this buffer, null while it is being filled
+	};
+
+	std::mutex m_Mutex;
+	std::vector<Request> m_Requests; // Binary heap under RequestOrder
+	unsigned long long m_NextSequence;
+
+	std::vector<StagingBuffer> m_StagingBuffers;
+	unsigned int m_StagingBufferSize;
+	unsigned int m_CurrentStagingBuffer; // The one being filled
+	unsigned long long m_UploadedBytes;
+
+	bool RetireStagingBuffer(StagingBuffer& staging);
+	bool AcquireStagingSpace(unsigned int size, StagingBuffer*& buffer, unsigned int& offset);
+	void CloseStagingBuffer();
+public:
+	// Levels bigger than stagingBufferSize are uploaded straight from client memory instead
+	TextureStreamer(unsigned int stagingBufferSize = 4 * 1024 * 1024, unsigned int stagingBufferCount = 4);
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// Any thread: queue one level of one layer, pixels must hold texture->GetLevelSize(level) bytes
+	void Enqueue(Texture* texture, unsigned int level, unsigned int layer, std::vector<unsigned char>&& pixels);
+
+	// Render thread: upload queued levels for up to budgetMilliseconds, stopping early when every staging buffer is still in flight
+	// The buffer filled this call is fenced at the end, so small levels share one buffer instead of taking one each
+	void Process(double budgetMilliseconds);
+
+	// Drop everything queued for texture, call before deleting it
+	void Cancel(const Texture* texture);
+
+	unsigned int GetPendingCount();
+	inline unsigned long long GetUploadedBytes() const { return m_UploadedBytes; }
+};
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "UploadQueue.h"
+#include "Renderer.h"
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+
+UploadQueue::UploadQueue()
+	: m_NextTicket(1), m_CompletedTicket(0), m_UploadContext(nullptr), m_StopUploadThread(false)
+{
+}
+
+UploadQueue::~UploadQueue()
+{
+	StopUploadThread();
+
+	// Fences belong to the main context, which has to be current while we are destroyed
+	for (const PendingFence& pending : m_Fences)
+	{
+		GLCall(glDeleteSync((GLsync)pending.fence));
+	}
+}
+
+unsigned long long UploadQueue::Enqueue(unsigned int bufferId, unsigned int offset, std::vector<unsigned char>&& staging)
+{
+	unsigned long long ticket;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		ticket = m_NextTicket++;
+		m_Requests.push_back({ ticket, bufferId, offset, std::move(staging) });
+	}
+	m_Condition.notify_one();
+	return ticket;
+}
+
+unsigned long long UploadQueue::Enqueue(unsigned int bufferId, unsigned int offset, const void* data, unsigned int size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	return Enqueue(bufferId, offset, std::vector<unsigned char>(bytes, bytes + size));
+}
+
+void UploadQueue::Upload(const UploadRequest& request)
+{
+	GLBufferSubData(request.bufferId, request.offset, (long long)request.staging.size(), request.staging.data());
+}
+
+void UploadQueue::InsertFence(unsigned long long lastTicket)
+{
+	GLCall(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	// Make sure the fence reaches the GPU even if nobody else flushes this context
+	GLCall(glFlush());
+
+	std::lock_guard<std::mutex> lock(m_FenceMutex);
+	m_Fences.push_back({ lastTicket, fence });
+}
+
+void UploadQueue::Process(double budgetMilliseconds)
+{
+	// The upload thread does the copies, we only retire its fences
+	if (m_UploadContext)
+	{
+		PollFences();
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	unsigned long long lastTicket = 0;
+
+	while (true)
+	{
+		UploadRequest request;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Requests.empty())
+				break;
+			request = std::move(m_Requests.front());
+			m_Requests.pop_front();
+		}
+
+		Upload(request);
+		lastTicket = request.ticket;
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		if (elapsed.count() >= budgetMilliseconds)
+			break;
+	}
+
+	if (lastTicket)
+		InsertFence(lastTicket);
+	PollFences();
+}
+
+void UploadQueue::PollFences()
+{
+	std::lock_guard<std::mutex> lock(m_FenceMutex);
+	while (!m_Fences.empty())
+	{
+		PendingFence& pending = m_Fences.front();
+		GLCall(GLenum result = glClientWaitSync((GLsync)pending.fence, 0, 0));
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+			break;
+
+		m_CompletedTicket.store(pending.lastTicket);
+		GLCall(glDeleteSync((GLsync)pending.fence));
+		m_Fences.pop_front();
+	}
+}
+
+void UploadQueue::StartUploadThread(GLFWwindow* mainWindow)
+{
+	ASSERT(!m_UploadContext);
+
+	// A second context only exists as part of a window, so make one nobody will see
+	// The caller's other hints, like the context version and profile, stay set so both contexts match
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_UploadContext = glfwCreateWindow(1, 1, "Upload", NULL, mainWindow);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	ASSERT(m_UploadContext);
+
+	m_StopUploadThread = false;
+	m_UploadThread = std::thread(&UploadQueue::UploadThreadMain, this);
+}
+
+void UploadQueue::StopUploadThread()
+{
+	if (!m_UploadContext)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_StopUploadThread = true;
+	}
+	m_Condition.notify_one();
+	m_UploadThread.join();
+
+	glfwDestroyWindow(m_UploadContext);
+	m_UploadContext = nullptr;
+}
+
+void UploadQueue::UploadThreadMain()
+{
+	glfwMakeContextCurrent(m_UploadContext);
+
+	while (true)
+	{
+		std::deque<UploadRequest> batch;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_StopUploadThread || !m_Requests.empty(); });
+			if (m_StopUploadThread && m_Requests.empty())
+				break;
+			batch.swap(m_Requests);
+		}
+
+		for (const UploadRequest& request : batch)
+		{
+			Upload(request);
+		}
+
+		// Sync objects are shared, so the render thread can poll this fence from its own context
+		InsertFence(batch.back().ticket);
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+// Moves buffer uploads off the constructors and out of the frame
+// Create the VertexBuffer/IndexBuffer with no data so its handle is usable right away, then have any thread
+// enqueue the contents. Either the render thread drains the queue within a time budget each frame, or an
+// upload thread with its own shared context drains it continuously. Completion is tracked with fences.
+class UploadQueue
+{
+private:
+	struct UploadRequest
+	{
+		unsigned long long ticket;
+		unsigned int bufferId; // GL buffer to write into
+		unsigned int offset; // Byte offset inside that buffer
+		std::vector<unsigned char> staging;
+	};
+
+	struct PendingFence
+	{
+		unsigned long long lastTicket; // Every ticket up to this one is done once the fence signals
+		void* fence; // GLsync
+	};
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<UploadRequest> m_Requests;
+	unsigned long long m_NextTicket;
+
+	std::mutex m_FenceMutex;
+	std::deque<PendingFence> m_Fences;
+	std::atomic<unsigned long long> m_CompletedTicket; // Uploads finish in order, so one watermark covers them all
+
+	GLFWwindow* m_UploadContext; // Hidden window sharing objects with the main context, null when the render thread uploads
+	std::thread m_UploadThread;
+	bool m_StopUploadThread;
+
+	void Upload(const UploadRequest& request);
+	void InsertFence(unsigned long long lastTicket);
+	void UploadThreadMain();
+public:
+	UploadQueue();
+	~UploadQueue();
+
+	// Any thread: queue data for an existing buffer, returns a ticket to poll with IsComplete
+	unsigned long long Enqueue(unsigned int bufferId, unsigned int offset, std::vector<unsigned char>&& staging);
+	unsigned long long Enqueue(unsigned int bufferId, unsigned int offset, const void* data, unsigned int size);
+
+	// Render thread: copy queued data into GL for up to budgetMilliseconds, always making progress on at least one upload
+	// Only polls fences while an upload thread is running
+	void Process(double budgetMilliseconds);
+	// Render thread: check outstanding fences and retire the uploads behind them
+	void PollFences();
+
+	// Any thread: true once the GPU has the data for this ticket
+	inline bool IsComplete(unsigned long long ticket) const { return ticket <= m_CompletedTicket.load(); }
+
+	// Main thread: create a hidden window sharing objects with mainWindow and hand uploads to a thread that owns it
+	// Must be called from the thread that created the GLFW windows, before any other uploads are queued
+	void StartUploadThread(GLFWwindow* mainWindow);
+	void StopUploadThread();
+};
\ No newline at end of file
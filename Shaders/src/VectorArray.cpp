@@ -1,9 +1,23 @@
 #include "VertexArray.h"
 #include "Renderer.h"
 
+// Separate attribute formats and buffer bindings (GL 4.3), otherwise we fall back to glVertexAttribPointer
+static bool HasVertexAttribBinding()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+}
+
 VertexArray::VertexArray()
+	: m_AttributeCount(0), m_BindingCount(0), m_StreamBuffer(0), m_StreamStride(0)
 {
-	GLCall(glGenVertexArrays(1, &m_RendererID));
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glCreateVertexArrays(1, &m_RendererID));
+	}
+	else
+	{
+		GLCall(glGenVertexArrays(1, &m_RendererID));
+	}
 }
 
 VertexArray::~VertexArray()
@@ -13,27 +27,100 @@ VertexArray::~VertexArray()
 
 void VertexArray::AddBuffer(const VertexBuffer & vb, const VertexBufferLayout & layout)
 {
-	// Bind this Vertex Array
-	Bind();
-	// Bind the Vertext Buffer
-	vb.Bind();
+	// Bind this Vertex Array, DSA edits it by name instead
+	if (!GLHasDirectStateAccess())
+		Bind();
+	// Every attribute in this layout reads from the same stream
+	BeginStream(vb, layout.GetStride());
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < elements.size(); i++) 
 	{
 		// Grab the current Vertex Buffer Layout
 		const auto& element = elements[i];
-		// Enable the vertex attribute
-		GLCall(glEnableVertexAttribArray(0));
-		// Define the structure of our buffer input
-		// First attribute, 2 components define this attribute, they are floats, not normalized, 2 float values define the size, next attribute offset
-		// This call will link index 0 of this vertex array will be bound to the currently bound array buffer (i.e. buffer^)
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
-		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		SetAttribute(element, offset);
+		offset += VertexBufferElement::GetSizeOfElement(element);
 	}
 	
 }
 
+void VertexArray::BeginStream(const VertexBuffer& vb, unsigned int stride)
+{
+	m_StreamBuffer = vb.GetRendererID();
+	m_StreamStride = stride;
+	m_StreamBindings.clear();
+
+	// glVertexAttribPointer captures whatever is bound to GL_ARRAY_BUFFER
+	if (!GLHasDirectStateAccess() && !HasVertexAttribBinding())
+		vb.Bind();
+}
+
+unsigned int VertexArray::GetStreamBinding(unsigned int divisor)
+{
+	// The divisor belongs to the binding point, so each divisor in a stream needs its own binding of the same buffer
+	for (const auto& binding : m_StreamBindings)
+		if (binding.first == divisor)
+			return binding.second;
+
+	unsigned int binding = m_BindingCount++;
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glVertexArrayVertexBuffer(m_RendererID, binding, m_StreamBuffer, 0, m_StreamStride));
+		GLCall(glVertexArrayBindingDivisor(m_RendererID, binding, divisor));
+	}
+	else
+	{
+		// The buffer gets its own binding point, attributes refer to it by index
+		GLCall(glBindVertexBuffer(binding, m_StreamBuffer, 0, m_StreamStride));
+		GLCall(glVertexBindingDivisor(binding, divisor));
+	}
+	m_StreamBindings.push_back(std::make_pair(divisor, binding));
+	return binding;
+}
+
+void VertexArray::SetAttribute(const VertexBufferElement& element, unsigned int offset)
+{
+	unsigned int index = m_AttributeCount++;
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glEnableVertexArrayAttrib(m_RendererID, index));
+		GLCall(glVertexArrayAttribFormat(m_RendererID, index, element.count, element.type, element.normalized, offset));
+		GLCall(glVertexArrayAttribBinding(m_RendererID, index, GetStreamBinding(element.divisor)));
+		return;
+	}
+
+	// Enable the vertex attribute
+	GLCall(glEnableVertexAttribArray(index));
+	if (HasVertexAttribBinding())
+	{
+		// Describe the attribute relative to the start of a vertex, then say which stream it reads from
+		GLCall(glVertexAttribFormat(index, element.count, element.type, element.normalized, offset));
+		GLCall(glVertexAttribBinding(index, GetStreamBinding(element.divisor)));
+	}
+	else
+	{
+		// Define the structure of our buffer input
+		// Attribute index, how many components, their type, normalized or not, size of a whole vertex, offset of this attribute
+		// This call will link this attribute to the currently bound array buffer
+		GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized, m_StreamStride, (const void*)(size_t)offset));
+		// 0 advances every vertex, N advances every N instances
+		GLCall(glVertexAttribDivisor(index, element.divisor));
+	}
+}
+
+void VertexArray::SetIndexBuffer(const IndexBuffer& ib)
+{
+	if (GLHasDirectStateAccess())
+	{
+		GLCall(glVertexArrayElementBuffer(m_RendererID, ib.GetRendererID()));
+		return;
+	}
+
+	// The element buffer binding is stored in whichever vertex array is bound
+	Bind();
+	ib.Bind();
+}
+
 void VertexArray::Bind() const
 {
 	GLCall(glBindVertexArray(m_RendererID));
@@ -1,16 +1,40 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GpuMemory.h"
 
-VertexBuffer::VertexBuffer(const void * data, unsigned int size)
+VertexBuffer::VertexBuffer(const void * data, unsigned int size, bool streaming)
+	: m_Size(size), m_Allocated(true)
 {
-	GLCall(glGenBuffers(1, &m_Renderer_Id));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_Renderer_Id));
-	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	// Counted before the GL allocation so the budget can refuse it, the buffer then exists but holds nothing
+	if (!GpuMemoryTracker::Get().TryAllocate(GpuMemoryCategory::VertexBuffer, size))
+	{
+		m_Size = 0;
+		m_Allocated = false;
+		data = nullptr;
+	}
+
+	if (GLHasDirectStateAccess())
+	{
+		// Immutable storage, still writable through glNamedBufferSubData for pools and streamed uploads
+		// Storage of size 0 is an error, an empty buffer is left without any like glBufferData would leave it
+		GLCall(glCreateBuffers(1, &m_Renderer_Id));
+		if (m_Size)
+		{
+			GLCall(glNamedBufferStorage(m_Renderer_Id, m_Size, data, GL_DYNAMIC_STORAGE_BIT | (streaming ? GL_MAP_WRITE_BIT : 0)));
+		}
+	}
+	else
+	{
+		GLCall(glGenBuffers(1, &m_Renderer_Id));
+		GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_Renderer_Id));
+		GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, data, streaming ? GL_STREAM_DRAW : GL_STATIC_DRAW));
+	}
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	GLCall(glDeleteBuffers(1, &m_Renderer_Id));
+	GpuMemoryTracker::Get().Free(GpuMemoryCategory::VertexBuffer, m_Size);
 }
 
 void VertexBuffer::Bind() const
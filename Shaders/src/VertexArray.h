@@ -1,19 +1,60 @@
 #pragma once
 
+#include <utility>
+#include <vector>
+
 #include "VertexBuffer.h"
+#include "IndexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "StaticVertexLayout.h"
 
 class VertexArray
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttributeCount; // Attribute indices used so far, the next AddBuffer carries on from here
+	unsigned int m_BindingCount; // Vertex buffer binding points used so far
+	unsigned int m_StreamBuffer; // Buffer of the stream being added
+	unsigned int m_StreamStride;
+	std::vector<std::pair<unsigned int, unsigned int>> m_StreamBindings; // Divisor -> binding point for the stream being added
+
+	// Start a new stream reading from vb
+	void BeginStream(const VertexBuffer& vb, unsigned int stride);
+	// Binding point of the current stream advancing at this divisor, created on first use
+	unsigned int GetStreamBinding(unsigned int divisor);
+	// Assign the next attribute index to element at offset inside the current stream
+	void SetAttribute(const VertexBufferElement& element, unsigned int offset);
 
+	template<typename LayoutType, unsigned int... Indices>
+	void AddStaticLayout(std::integer_sequence<unsigned int, Indices...>)
+	{
+		// Every element and offset here is a compile time constant
+		int expand[] = { (SetAttribute(LayoutType::template GetElement<Indices>(), LayoutType::template GetOffset<Indices>()), 0)..., 0 };
+		(void)expand;
+	}
 public:
 	VertexArray();
 	~VertexArray();
 
+	// Each call adds one vertex stream, so positions can live in one buffer and everything else in others
+	// Attribute indices carry on from the previous call, e.g. positions get 0 and the next buffer starts at 1
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
+	template<typename... Attributes>
+	void AddBuffer(const VertexBuffer& vb, const Layout<Attributes...>&)
+	{
+		if (!GLHasDirectStateAccess())
+			Bind();
+		BeginStream(vb, Layout<Attributes...>::Stride);
+		AddStaticLayout<Layout<Attributes...>>(std::make_integer_sequence<unsigned int, sizeof...(Attributes)>());
+	}
+
+	// Store the index buffer in this vertex array so binding the array binds it too
+	void SetIndexBuffer(const IndexBuffer& ib);
+
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetAttributeCount() const { return m_AttributeCount; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "VertexArrayCache.h"
+#include "Renderer.h"
+#include "Stats.h"
+
+#include <algorithm>
+
+size_t VertexArrayCache::HashStreams(const VertexStream* streams, unsigned int streamCount, unsigned int indexBufferId)
+{
+	size_t hash = 2166136261u;
+	auto combine = [&hash](size_t value) { hash = (hash ^ value) * 16777619u; };
+	for (unsigned int i = 0; i < streamCount; i++)
+	{
+		combine(streams[i].buffer->GetRendererID());
+		combine(streams[i].layout->GetHash());
+	}
+	combine(indexBufferId);
+	return hash;
+}
+
+bool VertexArrayCache::Matches(const Entry& entry, const VertexStream* streams, unsigned int streamCount, unsigned int indexBufferId)
+{
+	if (entry.layouts.size() != streamCount || entry.bufferIds[streamCount] != indexBufferId)
+		return false;
+	for (unsigned int i = 0; i < streamCount; i++)
+	{
+		if (entry.bufferIds[i] != streams[i].buffer->GetRendererID() || !(entry.layouts[i] == *streams[i].layout))
+			return false;
+	}
+	return true;
+}
+
+VertexArrayCache::VertexArrayCache()
+	: m_Size(0)
+{
+}
+
+VertexArrayCache::~VertexArrayCache()
+{
+	Clear();
+}
+
+std::shared_ptr<VertexArray> VertexArrayCache::Get(const VertexStream* streams, unsigned int streamCount, const IndexBuffer* indexBuffer)
+{
+	unsigned int indexBufferId = indexBuffer ? indexBuffer->GetRendererID() : 0;
+	size_t hash = HashStreams(streams, streamCount, indexBufferId);
+
+	RenderCounters& counters = GetRenderCounters();
+	auto it = m_Entries.find(hash);
+	if (it != m_Entries.end())
+	{
+		for (const Entry& entry : it->second)
+		{
+			if (Matches(entry, streams, streamCount, indexBufferId))
+			{
+				counters.vertexArrayCacheHits++;
+				return entry.vertexArray;
+			}
+		}
+	}
+	counters.vertexArrayCacheMisses++;
+
+	// Miss, build the vertex array with every stream and the index buffer baked in
+	Entry entry;
+	entry.vertexArray = std::make_shared<VertexArray>();
+	for (unsigned int i = 0; i < streamCount; i++)
+	{
+		entry.vertexArray->AddBuffer(*streams[i].buffer, *streams[i].layout);
+		entry.bufferIds.push_back(streams[i].buffer->GetRendererID());
+		entry.layouts.push_back(*streams[i].layout);
+	}
+	entry.bufferIds.push_back(indexBufferId);
+	if (indexBuffer)
+		entry.vertexArray->SetIndexBuffer(*indexBuffer);
+	// Without DSA the vertex array was bound to edit it, leave nothing bound behind
+	if (!GLHasDirectStateAccess())
+		entry.vertexArray->Unbind();
+
+	m_Entries[hash].push_back(entry);
+	m_Size++;
+	counters.vertexArrayCacheSize++;
+	return entry.vertexArray;
+}
+
+std::shared_ptr<VertexArray> VertexArrayCache::Get(const VertexBuffer& vb, const VertexBufferLayout& layout, const IndexBuffer* indexBuffer)
+{
+	VertexStream stream = { &vb, &layout };
+	return Get(&stream, 1, indexBuffer);
+}
+
+void VertexArrayCache::Evict(unsigned int bufferId)
+{
+	RenderCounters& counters = GetRenderCounters();
+	for (auto it = m_Entries.begin(); it != m_Entries.end();)
+	{
+		std::vector<Entry>& bucket = it->second;
+		for (auto entry = bucket.begin(); entry != bucket.end();)
+		{
+			if (std::find(entry->bufferIds.begin(), entry->bufferIds.end(), bufferId) != entry->bufferIds.end())
+			{
+				entry = bucket.erase(entry);
+				m_Size--;
+				counters.vertexArrayCacheSize--;
+			}
+			else
+			{
+				++entry;
+			}
+		}
+
+		if (bucket.empty())
+			it = m_Entries.erase(it);
+		else
+			++it;
+	}
+}
+
+void VertexArrayCache::Clear()
+{
+	GetRenderCounters().vertexArrayCacheSize -= m_Size;
+	m_Entries.clear();
+	m_Size = 0;
+}
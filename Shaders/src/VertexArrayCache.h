@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+
+// One vertex buffer and the layout it is read with
+struct VertexStream
+{
+	const VertexBuffer* buffer;
+	const VertexBufferLayout* layout;
+};
+
+// Hands out one shared VertexArray per unique set of (layout, vertex buffers, index buffer)
+// Meshes that share a layout and buffers, like everything in a GeometryPool, end up on the same vertex array
+class VertexArrayCache
+{
+private:
+	struct Entry
+	{
+		std::shared_ptr<VertexArray> vertexArray;
+		std::vector<unsigned int> bufferIds; // Vertex buffer of each stream in order, then the index buffer or 0, also used by Evict
+		std::vector<VertexBufferLayout> layouts; // Copies, so editing a layout after Get cannot change what the entry matches
+	};
+
+	// Keyed by HashStreams, a lookup hashes the streams in place and compares them against the entries in its bucket,
+	// so a hit never allocates. Layouts that hash the same land in one bucket and are still told apart in full
+	std::unordered_map<size_t, std::vector<Entry>> m_Entries;
+	unsigned int m_Size;
+
+	static size_t HashStreams(const VertexStream* streams, unsigned int streamCount, unsigned int indexBufferId);
+	static bool Matches(const Entry& entry, const VertexStream* streams, unsigned int streamCount, unsigned int indexBufferId);
+public:
+	VertexArrayCache();
+	~VertexArrayCache();
+
+	// Returns a vertex array reading the given streams in order, creating it on a miss
+	// indexBuffer may be null for non indexed geometry
+	std::shared_ptr<VertexArray> Get(const VertexStream* streams, unsigned int streamCount, const IndexBuffer* indexBuffer);
+	std::shared_ptr<VertexArray> Get(const VertexBuffer& vb, const VertexBufferLayout& layout, const IndexBuffer* indexBuffer);
+
+	// Drop every vertex array that uses this buffer, call before deleting the buffer so its id cannot be reused by mistake
+	void Evict(unsigned int bufferId);
+	void Clear();
+
+	inline unsigned int GetSize() const { return m_Size; }
+};
\ No newline at end of file
@@ -4,10 +4,18 @@ class VertexBuffer
 {
 private:
 	unsigned int m_Renderer_Id; // ID for the renderer that we use to fetch the object from the renderer
+	unsigned int m_Size; // Size of the buffer store in bytes
+	bool m_Allocated; // False when the memory budget refused the storage, the buffer is then empty
 public:
-	VertexBuffer(const void* data, unsigned int size);
+	// Over the memory budget the buffer is created empty, check IsAllocated
+	// Streaming buffers are rewritten every frame and can be mapped for writing, see GLBufferSubDataUnsynchronized
+	VertexBuffer(const void* data, unsigned int size, bool streaming = false);
 	~VertexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_Renderer_Id; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline bool IsAllocated() const { return m_Allocated; }
 };
\ No newline at end of file
@@ -4,12 +4,14 @@
 #include <GL/glew.h>
 
 #include "Renderer.h"
+#include "VertexFormats.h"
 
 struct VertexBufferElement
 {
 	unsigned int type;
 	unsigned int count;
 	bool normalized;
+	unsigned int divisor; // 0 for per vertex data, N to advance once every N instances
 
 	static unsigned int GetSizeOfType(unsigned int type)
 	{
@@ -17,12 +19,25 @@ struct VertexBufferElement
 		{
 			case GL_FLOAT: return 4;
 			case GL_UNSIGNED_INT: return 4;
-			case GL_UNSIGNED_BYTE: return 4;
+			case GL_UNSIGNED_BYTE: return 1;
+			case GL_SHORT: return 2;
+			case GL_UNSIGNED_SHORT: return 2;
+			case GL_HALF_FLOAT: return 2;
+			// Packed types hold every component in one 4 byte word
+			case GL_INT_2_10_10_10_REV: return 4;
 		}
 
 		ASSERT(false);
 		return 0;
 	}
+
+	// Size in bytes of the whole attribute
+	static unsigned int GetSizeOfElement(const VertexBufferElement& element)
+	{
+		if (element.type == GL_INT_2_10_10_10_REV)
+			return GetSizeOfType(element.type);
+		return element.count * GetSizeOfType(element.type);
+	}
 };
 
 class VertexBufferLayout
@@ -35,33 +50,111 @@ public:
 	VertexBufferLayout()
 		: m_Stride(0) {};
 
+	// divisor 0 is per vertex, 1 is per instance
 	template<typename T>
-	void Push(unsigned int count)
+	void Push(unsigned int count, unsigned int divisor = 0)
 	{
 		static_assert(false);
 	}
 
 	template<>
-	void Push<float>(unsigned int count)
+	void Push<float>(unsigned int count, unsigned int divisor)
 	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, divisor });
 		m_Stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
 	}
 
 	template<>
-	void Push<unsigned int>(unsigned int count)
+	void Push<unsigned int>(unsigned int count, unsigned int divisor)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, divisor });
 		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
 	}
 
 	template<>
-	void Push<unsigned char>(unsigned int count)
+	void Push<unsigned char>(unsigned int count, unsigned int divisor)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, divisor });
 		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
 	}
 
-	inline std::vector<VertexBufferElement> GetElements() const& { return m_Elements; }
+	// Normalized to [-1, 1], also used for octahedral normals
+	template<>
+	void Push<short>(unsigned int count, unsigned int divisor)
+	{
+		m_Elements.push_back({ GL_SHORT, count, GL_TRUE, divisor });
+		m_Stride += VertexBufferElement::GetSizeOfType(GL_SHORT) * count;
+	}
+
+	// Normalized to [0, 1]
+	template<>
+	void Push<unsigned short>(unsigned int count, unsigned int divisor)
+	{
+		m_Elements.push_back({ GL_UNSIGNED_SHORT, count, GL_TRUE, divisor });
+		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_SHORT) * count;
+	}
+
+	template<>
+	void Push<Half>(unsigned int count, unsigned int divisor)
+	{
+		m_Elements.push_back({ GL_HALF_FLOAT, count, GL_FALSE, divisor });
+		m_Stride += VertexBufferElement::GetSizeOfType(GL_HALF_FLOAT) * count;
+	}
+
+	// Signed normalized xyz with a 2 bit w, GL only accepts all 4 components
+	template<>
+	void Push<Packed1010102>(unsigned int count, unsigned int divisor)
+	{
+		ASSERT(count == 4);
+		m_Elements.push_back({ GL_INT_2_10_10_10_REV, count, GL_TRUE, divisor });
+		m_Stride += VertexBufferElement::GetSizeOfType(GL_INT_2_10_10_10_REV);
+	}
+
+	// Push an element described at runtime, e.g. from a file or a StaticVertexLayout
+	void Push(const VertexBufferElement& element)
+	{
+		m_Elements.push_back(element);
+		m_Stride += VertexBufferElement::GetSizeOfElement(element);
+	}
+
+	// A 4x4 float matrix takes 4 attribute locations, one column each
+	void PushMat4(unsigned int divisor = 1)
+	{
+		for (unsigned int column = 0; column < 4; column++)
+			Push(VertexBufferElement{ GL_FLOAT, 4, GL_FALSE, divisor });
+	}
+
+	// FNV-1a over every element, equal layouts always hash the same
+	size_t GetHash() const
+	{
+		size_t hash = 2166136261u;
+		auto combine = [&hash](unsigned int value) { hash = (hash ^ value) * 16777619u; };
+		for (const VertexBufferElement& element : m_Elements)
+		{
+			combine(element.type);
+			combine(element.count);
+			combine(element.normalized);
+			combine(element.divisor);
+		}
+		combine(m_Stride);
+		return hash;
+	}
+
+	// Same elements in the same order, the field by field check behind GetHash
+	bool operator==(const VertexBufferLayout& other) const
+	{
+		if (m_Stride != other.m_Stride || m_Elements.size() != other.m_Elements.size())
+			return false;
+		for (size_t i = 0; i < m_Elements.size(); i++)
+		{
+			const VertexBufferElement& a = m_Elements[i];
+			const VertexBufferElement& b = other.m_Elements[i];
+			if (a.type != b.type || a.count != b.count || a.normalized != b.normalized || a.divisor != b.divisor)
+				return false;
+		}
+		return true;
+	}
+
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
 };
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "VertexEncoding.h"
+#include "MathKernels.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define VERTEX_ENCODING_SSE2
+#endif
+
+// F16C is picked at runtime, GCC and Clang only allow its intrinsics in functions targeting it
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define VERTEX_ENCODING_F16C
+#if defined(_MSC_VER)
+#define VERTEX_ENCODING_F16C_TARGET
+#else
+#define VERTEX_ENCODING_F16C_TARGET __attribute__((target("avx,f16c")))
+#endif
+#endif
+
+static float Clamp(float value, float low, float high)
+{
+	// Written so NaN ends up as low
+	return value > low ? (value < high ? value : high) : low;
+}
+
+// Round to nearest even, overflow goes to infinity and NaN stays NaN
+static unsigned short FloatToHalf(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int magnitude = bits & 0x7FFFFFFF;
+
+	// NaN and infinity
+	if (magnitude >= 0x7F800000)
+		return (unsigned short)(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0));
+	// Too big for a half
+	if (magnitude >= 0x477FF000)
+		return (unsigned short)(sign | 0x7C00);
+	// Denormal halves, let the FPU do the rounding by adding a magic number
+	if (magnitude < 0x38800000)
+	{
+		float absolute;
+		memcpy(&absolute, &magnitude, sizeof(absolute));
+		absolute += 0.5f;
+		unsigned int result;
+		memcpy(&result, &absolute, sizeof(result));
+		return (unsigned short)(sign | (result - 0x3F000000));
+	}
+
+	// Normal halves, rebias the exponent and round the mantissa
+	unsigned int odd = (magnitude >> 13) & 1;
+	magnitude += 0xC8000FFF + odd;
+	return (unsigned short)(sign | (magnitude >> 13));
+}
+
+#ifdef VERTEX_ENCODING_F16C
+// Returns how many values it converted, always a multiple of 8
+VERTEX_ENCODING_F16C_TARGET
+static unsigned int EncodeHalfF16C(Half* destination, const float* source, unsigned int count)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128((__m128i*)(destination + i), halves);
+	}
+	return i;
+}
+#endif
+
+void EncodeHalf(Half* destination, const float* source, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef VERTEX_ENCODING_F16C
+	// The AVX2 level guarantees F16C as well
+	if (GetSimdLevel() == SimdLevel::AVX2)
+		i = EncodeHalfF16C(destination, source, count);
+#endif
+	for (; i < count; i++)
+		destination[i].bits = FloatToHalf(source[i]);
+}
+
+void EncodeSnorm16(short* destination, const float* source, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef VERTEX_ENCODING_SSE2
+	const __m128 low = _mm_set1_ps(-1.0f);
+	const __m128 high = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), low), high);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4), low), high);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = (short)std::lround(Clamp(source[i], -1.0f, 1.0f) * 32767.0f);
+}
+
+void EncodeUnorm16(unsigned short* destination, const float* source, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef VERTEX_ENCODING_SSE2
+	const __m128 low = _mm_setzero_ps();
+	const __m128 high = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(65535.0f);
+	// SSE2 can only pack with signed saturation, so shift into signed range and back again
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), low), high);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4), low), high);
+		__m128i ia = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), bias32);
+		__m128i ib = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(b, scale)), bias32);
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_xor_si128(_mm_packs_epi32(ia, ib), bias16));
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = (unsigned short)std::lround(Clamp(source[i], 0.0f, 1.0f) * 65535.0f);
+}
+
+void EncodeUnorm8(unsigned char* destination, const float* source, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef VERTEX_ENCODING_SSE2
+	const __m128 low = _mm_setzero_ps();
+	const __m128 high = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	for (; i + 16 <= count; i += 16)
+	{
+		// Clamp before converting, out of range values, infinities and NaN would convert to INT_MIN and pack to 0
+		// max returns its second operand for NaN, so NaN ends up as 0 like in the scalar tail
+		__m128 fa = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), low), high);
+		__m128 fb = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4), low), high);
+		__m128 fc = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 8), low), high);
+		__m128 fd = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 12), low), high);
+		__m128i a = _mm_cvtps_epi32(_mm_mul_ps(fa, scale));
+		__m128i b = _mm_cvtps_epi32(_mm_mul_ps(fb, scale));
+		__m128i c = _mm_cvtps_epi32(_mm_mul_ps(fc, scale));
+		__m128i d = _mm_cvtps_epi32(_mm_mul_ps(fd, scale));
+		// Every value is in [0, 255] now so both packs are exact
+		__m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = (unsigned char)std::lround(Clamp(source[i], 0.0f, 1.0f) * 255.0f);
+}
+
+void EncodeSnorm1010102(Packed1010102* destination, const float* source, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef VERTEX_ENCODING_SSE2
+	const __m128 low = _mm_set1_ps(-1.0f);
+	const __m128 high = _mm_set1_ps(1.0f);
+	const __m128 scaleXYZ = _mm_set1_ps(511.0f);
+	const __m128i mask10 = _mm_set1_epi32(0x3FF);
+	const __m128i mask2 = _mm_set1_epi32(0x3);
+	for (; i + 4 <= count; i += 4)
+	{
+		// Transpose 4 xyzw vectors so each register holds one component of every vector
+		__m128 x = _mm_loadu_ps(source + i * 4);
+		__m128 y = _mm_loadu_ps(source + i * 4 + 4);
+		__m128 z = _mm_loadu_ps(source + i * 4 + 8);
+		__m128 w = _mm_loadu_ps(source + i * 4 + 12);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		__m128i ix = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, low), high), scaleXYZ));
+		__m128i iy = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, low), high), scaleXYZ));
+		__m128i iz = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, low), high), scaleXYZ));
+		__m128i iw = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(w, low), high));
+
+		__m128i packed = _mm_and_si128(ix, mask10);
+		packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(iy, mask10), 10));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(iz, mask10), 20));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(iw, mask2), 30));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float* v = source + i * 4;
+		unsigned int x = (unsigned int)std::lround(Clamp(v[0], -1.0f, 1.0f) * 511.0f) & 0x3FF;
+		unsigned int y = (unsigned int)std::lround(Clamp(v[1], -1.0f, 1.0f) * 511.0f) & 0x3FF;
+		unsigned int z = (unsigned int)std::lround(Clamp(v[2], -1.0f, 1.0f) * 511.0f) & 0x3FF;
+		unsigned int w = (unsigned int)std::lround(Clamp(v[3], -1.0f, 1.0f)) & 0x3;
+		destination[i].bits = x | (y << 10) | (z << 20) | (w << 30);
+	}
+}
+
+void EncodeOctahedral(short* destination, const float* source, unsigned int count)
+{
+	unsigned int i = 0;
+#ifdef VERTEX_ENCODING_SSE2
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const float* n = source + i * 3;
+		__m128 x = _mm_setr_ps(n[0], n[3], n[6], n[9]);
+		__m128 y = _mm_setr_ps(n[1], n[4], n[7], n[10]);
+		__m128 z = _mm_setr_ps(n[2], n[5], n[8], n[11]);
+
+		// Project onto the octahedron |x| + |y| + |z| = 1
+		__m128 length = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+		__m128 inverse = _mm_div_ps(one, _mm_max_ps(length, _mm_set1_ps(1e-20f)));
+		x = _mm_mul_ps(x, inverse);
+		y = _mm_mul_ps(y, inverse);
+
+		// Fold the lower hemisphere over the diagonals
+		__m128 signX = _mm_or_ps(_mm_and_ps(x, signMask), one);
+		__m128 signY = _mm_or_ps(_mm_and_ps(y, signMask), one);
+		__m128 foldedX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, y)), signX);
+		__m128 foldedY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), signY);
+		__m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+		x = _mm_or_ps(_mm_and_ps(lower, foldedX), _mm_andnot_ps(lower, x));
+		y = _mm_or_ps(_mm_and_ps(lower, foldedY), _mm_andnot_ps(lower, y));
+
+		// Interleave back into xy pairs and quantize
+		__m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_unpacklo_ps(x, y), scale));
+		__m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_unpackhi_ps(x, y), scale));
+		_mm_storeu_si128((__m128i*)(destination + i * 2), _mm_packs_epi32(low, high));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float* n = source + i * 3;
+		float length = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+		float inverse = 1.0f / (length > 1e-20f ? length : 1e-20f);
+		float x = n[0] * inverse;
+		float y = n[1] * inverse;
+		if (n[2] < 0.0f)
+		{
+			float foldedX = (1.0f - std::fabs(y)) * (x < 0.0f ? -1.0f : 1.0f);
+			float foldedY = (1.0f - std::fabs(x)) * (y < 0.0f ? -1.0f : 1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+		destination[i * 2 + 0] = (short)std::lround(Clamp(x, -1.0f, 1.0f) * 32767.0f);
+		destination[i * 2 + 1] = (short)std::lround(Clamp(y, -1.0f, 1.0f) * 32767.0f);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "VertexFormats.h"
+
+// Quantize float vertex data into the compact formats from VertexFormats.h
+// Every encoder converts count floats (or count vectors where noted) and clamps out of range values
+
+void EncodeHalf(Half* destination, const float* source, unsigned int count);
+// [-1, 1] -> GL_SHORT normalized
+void EncodeSnorm16(short* destination, const float* source, unsigned int count);
+// [0, 1] -> GL_UNSIGNED_SHORT normalized
+void EncodeUnorm16(unsigned short* destination, const float* source, unsigned int count);
+// [0, 1] -> GL_UNSIGNED_BYTE normalized, for colors
+void EncodeUnorm8(unsigned char* destination, const float* source, unsigned int count);
+// count xyzw vectors in [-1, 1] -> GL_INT_2_10_10_10_REV normalized
+void EncodeSnorm1010102(Packed1010102* destination, const float* source, unsigned int count);
+
+// count unit xyz normals -> 2 GL_SHORT normalized values each using an octahedral mapping
+// Decode in the vertex shader with:
+//   vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+//   if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+//   n = normalize(n);
+void EncodeOctahedral(short* destination, const float* source, unsigned int count);
\ No newline at end of file
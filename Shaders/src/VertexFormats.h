@@ -0,0 +1,15 @@
+#pragma once
+
+// Storage types for compact vertex attributes, used with VertexBufferLayout::Push and the encoders in VertexEncoding.h
+
+// IEEE 754 half precision float (GL_HALF_FLOAT)
+struct Half
+{
+	unsigned short bits;
+};
+
+// Signed normalized x, y, z in 10 bits each and w in 2 bits (GL_INT_2_10_10_10_REV)
+struct Packed1010102
+{
+	unsigned int bits;
+};
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool()
+	: m_Task(nullptr), m_TaskCount(0), m_NextTask(0), m_FinishedTasks(0), m_ActiveWorkers(0), m_Generation(0), m_Stop(false)
+{
+	// The thread calling ParallelFor works too, so one fewer worker than hardware threads
+	unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	for (unsigned int i = 0; i < workerCount; i++)
+		m_Threads.emplace_back(&WorkerPool::WorkerMain, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_WorkReady.notify_all();
+	for (std::thread& thread : m_Threads)
+		thread.join();
+}
+
+WorkerPool& WorkerPool::Get()
+{
+	static WorkerPool pool;
+	return pool;
+}
+
+unsigned int WorkerPool::RunTasks()
+{
+	unsigned int ran = 0;
+	while (true)
+	{
+		unsigned int task;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_NextTask >= m_TaskCount)
+				break;
+			task = m_NextTask++;
+		}
+		(*m_Task)(task);
+		ran++;
+	}
+	return ran;
+}
+
+void WorkerPool::WorkerMain()
+{
+	unsigned long long seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkReady.wait(lock, [this, seenGeneration]() { return m_Stop || m_Generation != seenGeneration; });
+			if (m_Stop)
+				return;
+			seenGeneration = m_Generation;
+			m_ActiveWorkers++;
+		}
+
+		unsigned int ran = RunTasks();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_FinishedTasks += ran;
+			m_ActiveWorkers--;
+		}
+		m_WorkDone.notify_one();
+	}
+}
+
+void WorkerPool::ParallelFor(unsigned int taskCount, const std::function<void(unsigned int task)>& task)
+{
+	if (taskCount == 0)
+		return;
+	if (taskCount == 1 || m_Threads.empty())
+	{
+		for (unsigned int i = 0; i < taskCount; i++)
+			task(i);
+		return;
+	}
+
+	std::lock_guard<std::mutex> submitLock(m_SubmitMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Task = &task;
+		m_TaskCount = taskCount;
+		m_NextTask = 0;
+		m_FinishedTasks = 0;
+		m_Generation++;
+	}
+	m_WorkReady.notify_all();
+
+	unsigned int ran = RunTasks();
+
+	// Also wait for workers still on their way out, so none of them can touch the next job's state with this one's task
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_FinishedTasks += ran;
+	m_WorkDone.wait(lock, [this]() { return m_FinishedTasks == m_TaskCount && m_ActiveWorkers == 0; });
+	m_Task = nullptr;
+	m_TaskCount = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads started once and kept asleep between jobs, so per frame work like culling does not pay for thread creation
+// ParallelFor hands out task indices to the workers and the calling thread, and returns once every task has run
+// Jobs from several threads run one after another, a task must not call ParallelFor itself
+class WorkerPool
+{
+private:
+	std::vector<std::thread> m_Threads;
+	std::mutex m_SubmitMutex; // Held for the whole of a ParallelFor
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkReady;
+	std::condition_variable m_WorkDone;
+
+	// The current job, only changed under m_Mutex while no worker is inside it
+	const std::function<void(unsigned int)>* m_Task;
+	unsigned int m_TaskCount;
+	unsigned int m_NextTask;
+	unsigned int m_FinishedTasks;
+	unsigned int m_ActiveWorkers; // Workers that picked up the current job and have not left it yet
+	unsigned long long m_Generation; // Bumped for every job so sleeping workers can tell a new one arrived
+	bool m_Stop;
+
+	WorkerPool();
+	void WorkerMain();
+	// Run tasks of the current job until none are left, returns how many this thread ran
+	unsigned int RunTasks();
+public:
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	static WorkerPool& Get();
+
+	void ParallelFor(unsigned int taskCount, const std::function<void(unsigned int task)>& task);
+
+	// Workers plus the calling thread, a good task count for evenly sized chunks
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Threads.size() + 1; }
+};
\ No newline at end of file